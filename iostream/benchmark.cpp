@@ -0,0 +1,377 @@
+// Throughput of the stdlike streams against std::cin/std::cout (synced and unsynced with stdio),
+// scanf/printf and std::from_chars/std::to_chars on generated inputs.
+//
+// Usage: bench_iostream [values per dataset, 1000000 by default]
+//
+// stdin and stdout are redirected to temporary files, so every method goes through the same
+// descriptors; the table is printed to the original stdout. Floating values are written with 17
+// significant digits by std::cout and printf, so every output reads back exactly.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "implementation/iostream.hpp"
+#include "util.h"
+
+namespace {
+
+struct record {
+    int number;
+    long long wide;
+    double real;
+    char symbol;
+
+    bool operator==(const record&) const = default;
+};
+
+struct measurement {
+    std::string dataset;
+    std::string method;
+    bool output;
+    size_t bytes;
+    size_t values;
+    double seconds;
+};
+
+std::vector<measurement> results;
+
+template <class Out>
+void emit(Out& out, int value) {
+    out << value << ' ';
+}
+
+template <class Out>
+void emit(Out& out, long long value) {
+    out << value << ' ';
+}
+
+template <class Out>
+void emit(Out& out, double value) {
+    out << value << ' ';
+}
+
+template <class Out>
+void emit(Out& out, char value) {
+    out << value;
+}
+
+template <class Out>
+void emit(Out& out, const record& value) {
+    out << value.number << ' ' << value.wide << ' ' << value.real << ' ' << value.symbol << '\n';
+}
+
+template <class In>
+bool take(In& in, int& value) {
+    return !(in >> value).fail();
+}
+
+template <class In>
+bool take(In& in, long long& value) {
+    return !(in >> value).fail();
+}
+
+template <class In>
+bool take(In& in, double& value) {
+    return !(in >> value).fail();
+}
+
+template <class In>
+bool take(In& in, char& value) {
+    return !(in >> value).fail();
+}
+
+template <class In>
+bool take(In& in, record& value) {
+    return !(in >> value.number >> value.wide >> value.real >> value.symbol).fail();
+}
+
+void emit_stdio(int value) {
+    printf("%d ", value);
+}
+
+void emit_stdio(long long value) {
+    printf("%lld ", value);
+}
+
+void emit_stdio(double value) {
+    printf("%.17g ", value);
+}
+
+void emit_stdio(char value) {
+    putchar(value);
+}
+
+void emit_stdio(const record& value) {
+    printf("%d %lld %.17g %c\n", value.number, value.wide, value.real, value.symbol);
+}
+
+bool take_stdio(int& value) {
+    return scanf("%d", &value) == 1;
+}
+
+bool take_stdio(long long& value) {
+    return scanf("%lld", &value) == 1;
+}
+
+bool take_stdio(double& value) {
+    return scanf("%lf", &value) == 1;
+}
+
+bool take_stdio(char& value) {
+    return scanf(" %c", &value) == 1;
+}
+
+bool take_stdio(record& value) {
+    return scanf("%d %lld %lf %c", &value.number, &value.wide, &value.real, &value.symbol) == 4;
+}
+
+// Longest text of a number and of a whole record.
+constexpr size_t kMaxNumberChars = 32;
+constexpr size_t kMaxChars = 4 * kMaxNumberChars;
+
+template <class T>
+char* emit_chars(char* out, T value) {
+    out = std::to_chars(out, out + kMaxNumberChars, value).ptr;
+    *out = ' ';
+    return out + 1;
+}
+
+char* emit_chars(char* out, char value) {
+    *out = value;
+    return out + 1;
+}
+
+char* emit_chars(char* out, const record& value) {
+    out = emit_chars(out, value.number);
+    out = emit_chars(out, value.wide);
+    out = emit_chars(out, value.real);
+    *out++ = value.symbol;
+    *out = '\n';
+    return out + 1;
+}
+
+const char* skip_spaces(const char* first, const char* last) {
+    while (first != last && stdlike::utils::isspace(*first)) {
+        ++first;
+    }
+    return first;
+}
+
+template <class T>
+const char* take_chars(const char* first, const char* last, T& value) {
+    auto [end, error] = std::from_chars(skip_spaces(first, last), last, value);
+    return error == std::errc{} ? end : nullptr;
+}
+
+const char* take_chars(const char* first, const char* last, char& value) {
+    first = skip_spaces(first, last);
+    if (first == last) {
+        return nullptr;
+    }
+    value = *first;
+    return first + 1;
+}
+
+const char* take_chars(const char* first, const char* last, record& value) {
+    first = take_chars(first, last, value.number);
+    first = first != nullptr ? take_chars(first, last, value.wide) : nullptr;
+    first = first != nullptr ? take_chars(first, last, value.real) : nullptr;
+    return first != nullptr ? take_chars(first, last, value.symbol) : nullptr;
+}
+
+std::string read_file(int fd) {
+    std::string text;
+    char buffer[1 << 16];
+    for (ssize_t size; (size = read(fd, buffer, sizeof(buffer))) > 0;) {
+        text.append(buffer, size);
+    }
+    return text;
+}
+
+void rewind_input() {
+    std::cin.clear();
+    clearerr(stdin);
+    rewind(stdin);
+    std::cin.seekg(0);
+    lseek(STDIN_FILENO, 0, SEEK_SET);
+}
+
+void reset_output() {
+    ftruncate(STDOUT_FILENO, 0);
+    lseek(STDOUT_FILENO, 0, SEEK_SET);
+}
+
+size_t output_size() {
+    return lseek(STDOUT_FILENO, 0, SEEK_END);
+}
+
+double seconds(const Timer& timer) {
+    return std::chrono::duration<double>(timer.GetTimes().wall_time).count();
+}
+
+template <class T, class Read>
+void bench_read(const char* dataset, const char* method, const std::vector<T>& values,
+                size_t bytes, Read read) {
+    rewind_input();
+    std::vector<T> back(values.size());
+    Timer timer;
+    size_t count = 0;
+    while (count < back.size() && read(back[count])) {
+        ++count;
+    }
+    results.push_back({dataset, method, false, bytes, values.size(), seconds(timer)});
+    if (count != values.size() || back != values) {
+        fprintf(stderr, "%s, %s: read %zu of %zu values or got wrong ones\n", dataset, method,
+                count, values.size());
+    }
+}
+
+template <class T, class Write>
+void bench_write(const char* dataset, const char* method, const std::vector<T>& values,
+                 Write write) {
+    reset_output();
+    Timer timer;
+    write();
+    results.push_back({dataset, method, true, output_size(), values.size(), seconds(timer)});
+}
+
+template <class T>
+void bench(const char* dataset, const std::vector<T>& values, bool synced) {
+    std::string text;
+    char buffer[kMaxChars];
+    for (const T& value : values) {
+        text.append(buffer, emit_chars(buffer, value));
+    }
+    ftruncate(STDIN_FILENO, 0);
+    pwrite(STDIN_FILENO, text.data(), text.size(), 0);
+
+    const char* std_name = synced ? "std::cin (synced)" : "std::cin (unsynced)";
+    bench_read(dataset, std_name, values, text.size(),
+               [](T& value) { return take(std::cin, value); });
+    bench_write(dataset, synced ? "std::cout (synced)" : "std::cout (unsynced)", values, [&] {
+        for (const T& value : values) {
+            emit(std::cout, value);
+        }
+        std::cout.flush();
+    });
+    if (!synced) {
+        return;
+    }
+
+    std::optional<stdlike::istream> in;
+    bench_read(dataset, "stdlike::istream", values, text.size(), [&](T& value) {
+        if (!in) {
+            in.emplace(STDIN_FILENO);
+        }
+        return take(*in, value);
+    });
+    bench_write(dataset, "stdlike::cout", values, [&] {
+        for (const T& value : values) {
+            emit(stdlike::cout, value);
+        }
+        stdlike::cout.flush();
+    });
+
+    bench_read(dataset, "scanf", values, text.size(), [](T& value) { return take_stdio(value); });
+    bench_write(dataset, "printf", values, [&] {
+        for (const T& value : values) {
+            emit_stdio(value);
+        }
+        fflush(stdout);
+    });
+
+    std::string input;
+    const char* first = nullptr;
+    bench_read(dataset, "std::from_chars", values, text.size(), [&](T& value) {
+        if (first == nullptr) {
+            input = read_file(STDIN_FILENO);
+            first = input.data();
+        }
+        first = take_chars(first, input.data() + input.size(), value);
+        return first != nullptr;
+    });
+    bench_write(dataset, "std::to_chars", values, [&] {
+        std::string buffer(1 << 16, '\0');
+        char* out = buffer.data();
+        for (const T& value : values) {
+            if (static_cast<size_t>(buffer.data() + buffer.size() - out) < kMaxChars) {
+                write(STDOUT_FILENO, buffer.data(), out - buffer.data());
+                out = buffer.data();
+            }
+            out = emit_chars(out, value);
+        }
+        write(STDOUT_FILENO, buffer.data(), out - buffer.data());
+    });
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? std::stoull(argv[1]) : 1'000'000;
+    FILE* report = fdopen(dup(STDOUT_FILENO), "w");
+    FILE* input = tmpfile();
+    FILE* output = tmpfile();
+    if (report == nullptr || input == nullptr || output == nullptr) {
+        perror("bench_iostream");
+        return 1;
+    }
+    dup2(fileno(input), STDIN_FILENO);
+    dup2(fileno(output), STDOUT_FILENO);
+    std::cout.precision(17);
+
+    RandomGenerator rnd;
+    auto ints = rnd.GenIntegralVector<int>(count, std::numeric_limits<int>::min(),
+                                           std::numeric_limits<int>::max());
+    auto longs = rnd.GenIntegralVector<long long>(count, std::numeric_limits<long long>::min(),
+                                                  std::numeric_limits<long long>::max());
+    std::vector<double> doubles(count);
+    for (double& value : doubles) {
+        value = rnd.GenRealArray<1>(-1e9, 1e9)[0];
+    }
+    std::string letters = rnd.GenString(count);
+    std::vector<char> chars(letters.begin(), letters.end());
+    std::vector<record> mixed(count / 4);
+    for (size_t i = 0; i < mixed.size(); ++i) {
+        mixed[i] = {ints[i], longs[i], doubles[i], chars[i]};
+    }
+
+    for (bool synced : {true, false}) {
+        if (!synced) {
+            std::ios::sync_with_stdio(false);
+        }
+        bench("int", ints, synced);
+        bench("long long", longs, synced);
+        bench("double", doubles, synced);
+        bench("char", chars, synced);
+        bench("mixed", mixed, synced);
+    }
+
+    std::vector<std::string> datasets;
+    for (const auto& result : results) {
+        if (std::find(datasets.begin(), datasets.end(), result.dataset) == datasets.end()) {
+            datasets.push_back(result.dataset);
+        }
+    }
+    fprintf(report, "%-10s %-6s %-22s %10s %12s %12s\n", "dataset", "", "method", "seconds",
+            "MB/s", "Mvalues/s");
+    for (const auto& dataset : datasets) {
+        for (bool output : {false, true}) {
+            for (const auto& result : results) {
+                if (result.dataset != dataset || result.output != output) {
+                    continue;
+                }
+                fprintf(report, "%-10s %-6s %-22s %10.3f %12.1f %12.2f\n", dataset.c_str(),
+                        output ? "write" : "read", result.method.c_str(), result.seconds,
+                        result.bytes / result.seconds / 1e6, result.values / result.seconds / 1e6);
+            }
+        }
+    }
+    fclose(report);
+}
@@ -0,0 +1,75 @@
+#include "async_ostream.hpp"
+
+namespace stdlike {
+
+async_ostream::async_ostream(int fd, size_t buffer_size, size_t max_backlog)
+    : ostream(fd, buffer_size), max_backlog_(std::max<size_t>(max_backlog, 1)) {
+    bypass_ = false;
+    writer_ = std::thread([this] { run(); });
+}
+
+async_ostream::~async_ostream() {
+    flush();
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    pending_ready_.notify_one();
+    writer_.join();
+}
+
+ostream& async_ostream::flush() {
+    error_ = false;
+    write_buffer();
+    std::unique_lock lock(mutex_);
+    pending_done_.wait(lock, [this] { return pending_.empty(); });
+    error_ = std::exchange(failed_, false) || error_;
+    return *this;
+}
+
+size_t async_ostream::backlog() {
+    std::lock_guard lock(mutex_);
+    return pending_.size();
+}
+
+void async_ostream::write_buffer() {
+    if (offset_ == 0) {
+        return;
+    }
+    std::unique_lock lock(mutex_);
+    pending_done_.wait(lock, [this] { return pending_.size() < max_backlog_; });
+    pending_.push_back({std::move(buffer_), capacity_, offset_});
+    while (!spare_.empty() && !buffer_) {
+        if (spare_.back().capacity == capacity_) {
+            buffer_ = std::move(spare_.back().data);
+        }
+        spare_.pop_back();
+    }
+    error_ = std::exchange(failed_, false) || error_;
+    lock.unlock();
+    pending_ready_.notify_one();
+    if (!buffer_) {
+        buffer_ = utils::allocate_buffer(capacity_);
+    }
+    offset_ = 0;
+}
+
+void async_ostream::run() {
+    std::unique_lock lock(mutex_);
+    while (true) {
+        pending_ready_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            return;
+        }
+        chunk& front = pending_.front();
+        lock.unlock();
+        iovec part{front.data.get(), front.size};
+        bool written = utils::write_all(fd_, &part, 1);
+        lock.lock();
+        failed_ = failed_ || !written;
+        spare_.push_back(std::move(front));
+        pending_.pop_front();
+        pending_done_.notify_all();
+    }
+}
+}  // namespace stdlike
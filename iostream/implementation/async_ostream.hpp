@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "iostream.hpp"
+
+namespace stdlike {
+
+// Output stream whose full buffers are written by a background thread. Filling a buffer only
+// swaps in a spare one, so the caller blocks only when max_backlog buffers are still pending.
+class async_ostream : public ostream {
+public:
+    static constexpr size_t kDefaultBacklog = 4;
+
+    explicit async_ostream(int fd = STDOUT_FILENO, size_t buffer_size = kDefaultBufferSize,
+                           size_t max_backlog = kDefaultBacklog);
+
+    ~async_ostream();
+
+    // Queues the current buffer and waits until everything queued so far is written.
+    ostream& flush() override;
+
+    size_t backlog();
+
+protected:
+    void write_buffer() override;
+
+private:
+    struct chunk {
+        utils::buffer_ptr data;
+        size_t capacity;
+        size_t size;
+    };
+
+    void run();
+
+    size_t max_backlog_;
+    std::mutex mutex_;
+    std::condition_variable pending_ready_;
+    std::condition_variable pending_done_;
+    std::deque<chunk> pending_;
+    std::vector<chunk> spare_;
+    bool failed_{false};
+    bool stop_{false};
+    std::thread writer_;
+};
+}  // namespace stdlike
@@ -0,0 +1,104 @@
+#include "binary.hpp"
+
+namespace stdlike {
+
+bool detail::binary_access::refill(istream& in, size_t size) {
+    in.flush_tied();
+    while (in.buffer_size_ - in.offset_ < static_cast<ssize_t>(size)) {
+        if (!in.refill_tail()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool detail::binary_access::read_varint_tail(istream& in, uint64_t& value) {
+    // Near the end of the input a varint may be shorter than the fast path needs.
+    refill(in, kMaxVarintSize);
+    const char* first = in.buffer_ + in.offset_;
+    const char* last = in.buffer_ + std::max(in.buffer_size_, in.offset_);
+    const char* end = std::find_if(first, last, [](char byte) {
+        return static_cast<unsigned char>(byte) < 0x80;
+    });
+    value = 0;
+    if (end == last || end - first >= static_cast<ssize_t>(kMaxVarintSize)) {
+        in.error_ = true;
+        return false;
+    }
+    char local[kMaxVarintSize] = {};
+    memcpy(local, first, end - first + 1);
+    if (decode_varint(local, value) == nullptr) {
+        in.error_ = true;
+        return false;
+    }
+    in.offset_ += end - first + 1;
+    return true;
+}
+
+bool detail::binary_access::read_bytes(istream& in, char* data, size_t size) {
+    in.flush_tied();
+    while (size > 0) {
+        ssize_t available = in.buffer_size_ - in.offset_;
+        if (available > 0) {
+            size_t chunk = std::min(size, static_cast<size_t>(available));
+            memcpy(data, in.buffer_ + in.offset_, chunk);
+            in.offset_ += static_cast<ssize_t>(chunk);
+            data += chunk;
+            size -= chunk;
+            continue;
+        }
+        if (size >= in.capacity_ && !in.is_mapped()) {
+            // The buffer is drained, so large tails are read straight into data.
+            if (in.buffer_size_ > 0) {
+                in.absolute_offset_ += in.buffer_size_;
+            }
+            in.buffer_size_ = in.offset_ = 0;
+            ssize_t read_size = in.read_input(data, size, in.absolute_offset_);
+            if (read_size <= 0) {
+                return false;
+            }
+            in.absolute_offset_ += read_size;
+            data += read_size;
+            size -= static_cast<size_t>(read_size);
+            continue;
+        }
+        if (!in.refill_tail()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+binary_ostream::binary_ostream(ostream& out, binary_encoding encoding)
+    : out_(out), encoding_(encoding) {
+}
+
+binary_ostream& binary_ostream::flush() {
+    out_.flush();
+    return *this;
+}
+
+ostream& binary_ostream::stream() {
+    return out_;
+}
+
+bool binary_ostream::fail() {
+    return out_.fail();
+}
+
+binary_istream::binary_istream(istream& in, binary_encoding encoding)
+    : in_(in), encoding_(encoding) {
+}
+
+istream& binary_istream::stream() {
+    return in_;
+}
+
+bool binary_istream::fail() {
+    return in_.fail();
+}
+
+void binary_istream::clear() {
+    in_.clear();
+}
+}  // namespace stdlike
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "iostream.hpp"
+
+namespace concepts {
+template <typename T>
+concept IsBinaryProcessed = std::is_arithmetic_v<T>;
+}  // namespace concepts
+
+namespace stdlike {
+
+// fixed: little-endian, sizeof(T) bytes. varint: LEB128 for integers (zigzag for signed ones);
+// floating values stay fixed in both encodings.
+enum class binary_encoding { fixed, varint };
+
+namespace detail {
+inline constexpr size_t kMaxVarintSize = 10;
+
+template <class T>
+T to_little_endian(T value) {
+    if constexpr (std::endian::native == std::endian::little || sizeof(T) == 1) {
+        return value;
+    } else {
+        auto* bytes = reinterpret_cast<unsigned char*>(&value);
+        std::reverse(bytes, bytes + sizeof(T));
+        return value;
+    }
+}
+
+template <class T>
+uint64_t zigzag(T value) {
+    if constexpr (std::is_signed_v<T>) {
+        auto wide = static_cast<int64_t>(value);
+        return (static_cast<uint64_t>(wide) << 1) ^ static_cast<uint64_t>(wide >> 63);
+    } else {
+        return static_cast<uint64_t>(value);
+    }
+}
+
+template <class T>
+T unzigzag(uint64_t value) {
+    if constexpr (std::is_signed_v<T>) {
+        return static_cast<T>(static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1));
+    } else {
+        return static_cast<T>(value);
+    }
+}
+
+inline char* encode_varint(uint64_t value, char* out) {
+    while (value >= 0x80) {
+        *out++ = static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<char>(value);
+    return out;
+}
+
+// Decodes from at least kMaxVarintSize readable bytes; nullptr on an overlong encoding.
+inline const char* decode_varint(const char* in, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        auto byte = static_cast<unsigned char>(*in++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return shift == 63 && byte > 1 ? nullptr : in;
+        }
+    }
+    return nullptr;
+}
+
+struct binary_access {
+    static char* reserve(ostream& out, size_t size) {
+        return out.reserve(size);
+    }
+
+    static void commit(ostream& out, char* end) {
+        out.offset_ = end - out.buffer_.get();
+    }
+
+    // Makes size bytes readable at data(in), refilling and compacting the buffer.
+    static bool ensure(istream& in, size_t size) {
+        return in.buffer_size_ - in.offset_ >= static_cast<ssize_t>(size) || refill(in, size);
+    }
+
+    static const char* data(istream& in) {
+        return in.buffer_ + in.offset_;
+    }
+
+    static void consume(istream& in, size_t size) {
+        in.offset_ += static_cast<ssize_t>(size);
+    }
+
+    static bool read_varint(istream& in, uint64_t& value) {
+        if (in.buffer_size_ - in.offset_ < static_cast<ssize_t>(kMaxVarintSize)) {
+            return read_varint_tail(in, value);
+        }
+        const char* end = decode_varint(in.buffer_ + in.offset_, value);
+        if (end == nullptr) {
+            in.error_ = true;
+            return false;
+        }
+        in.offset_ = end - in.buffer_;
+        return true;
+    }
+
+    static void set_fail(istream& in) {
+        in.error_ = true;
+    }
+
+    static bool refill(istream& in, size_t size);
+
+    static bool read_varint_tail(istream& in, uint64_t& value);
+
+    static bool read_bytes(istream& in, char* data, size_t size);
+};
+}  // namespace detail
+
+// Binary writer over the buffer of an existing ostream.
+class binary_ostream {
+public:
+    explicit binary_ostream(ostream& out, binary_encoding encoding = binary_encoding::fixed);
+
+    template <concepts::IsBinaryProcessed T>
+    binary_ostream& operator<<(T value);
+
+    // Writes values back to back; fixed arrays go through a single memcpy or writev.
+    template <concepts::IsBinaryProcessed T>
+    binary_ostream& write(std::span<const T> values);
+
+    binary_ostream& flush();
+
+    ostream& stream();
+
+    bool fail();
+
+private:
+    ostream& out_;
+    binary_encoding encoding_;
+};
+
+// Binary reader over the buffer of an existing istream. Truncated or malformed input, including a
+// fixed bool byte other than 0 or 1, sets fail(), which stays set until clear().
+class binary_istream {
+public:
+    explicit binary_istream(istream& in, binary_encoding encoding = binary_encoding::fixed);
+
+    template <concepts::IsBinaryProcessed T>
+    binary_istream& operator>>(T& value);
+
+    // Reads values.size() values; large fixed arrays are read straight into values.
+    template <concepts::IsBinaryProcessed T>
+    binary_istream& read(std::span<T> values);
+
+    istream& stream();
+
+    bool fail();
+
+    // Clears the state of the underlying istream.
+    void clear();
+
+private:
+    istream& in_;
+    binary_encoding encoding_;
+};
+
+template <concepts::IsBinaryProcessed T>
+binary_ostream& binary_ostream::operator<<(T value) {
+    if constexpr (std::is_integral_v<T>) {
+        if (encoding_ == binary_encoding::varint) {
+            char local[detail::kMaxVarintSize];
+            char* out = detail::binary_access::reserve(out_, detail::kMaxVarintSize);
+            char* end = detail::encode_varint(detail::zigzag(value), out != nullptr ? out : local);
+            if (out != nullptr) {
+                detail::binary_access::commit(out_, end);
+            } else {
+                out_.write(local, end - local);
+            }
+            return *this;
+        }
+    }
+    value = detail::to_little_endian(value);
+    if (char* out = detail::binary_access::reserve(out_, sizeof(T)); out != nullptr) {
+        memcpy(out, &value, sizeof(T));
+        detail::binary_access::commit(out_, out + sizeof(T));
+    } else {
+        out_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    return *this;
+}
+
+template <concepts::IsBinaryProcessed T>
+binary_ostream& binary_ostream::write(std::span<const T> values) {
+    if ((encoding_ == binary_encoding::fixed || !std::is_integral_v<T>) &&
+        std::endian::native == std::endian::little) {
+        out_.write(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+        return *this;
+    }
+    for (T value : values) {
+        *this << value;
+    }
+    return *this;
+}
+
+template <concepts::IsBinaryProcessed T>
+binary_istream& binary_istream::operator>>(T& value) {
+    if constexpr (std::is_integral_v<T>) {
+        if (encoding_ == binary_encoding::varint) {
+            uint64_t raw = 0;
+            bool ok = detail::binary_access::read_varint(in_, raw);
+            value = detail::unzigzag<T>(raw);
+            if (ok && detail::zigzag(value) != raw) {
+                detail::binary_access::set_fail(in_);
+            }
+            return *this;
+        }
+    }
+    if (!detail::binary_access::ensure(in_, sizeof(T))) {
+        value = T{};
+        detail::binary_access::set_fail(in_);
+        return *this;
+    }
+    if constexpr (std::is_same_v<T, bool>) {
+        auto byte = static_cast<unsigned char>(*detail::binary_access::data(in_));
+        value = byte == 1;
+        if (byte > 1) {
+            detail::binary_access::set_fail(in_);
+        }
+    } else {
+        memcpy(&value, detail::binary_access::data(in_), sizeof(T));
+        value = detail::to_little_endian(value);
+    }
+    detail::binary_access::consume(in_, sizeof(T));
+    return *this;
+}
+
+template <concepts::IsBinaryProcessed T>
+binary_istream& binary_istream::read(std::span<T> values) {
+    if ((encoding_ == binary_encoding::fixed || !std::is_integral_v<T>) &&
+        !std::is_same_v<T, bool>) {
+        if (!detail::binary_access::read_bytes(in_, reinterpret_cast<char*>(values.data()),
+                                               values.size_bytes())) {
+            detail::binary_access::set_fail(in_);
+        }
+        for (T& value : values) {
+            value = detail::to_little_endian(value);
+        }
+        return *this;
+    }
+    for (T& value : values) {
+        *this >> value;
+    }
+    return *this;
+}
+}  // namespace stdlike
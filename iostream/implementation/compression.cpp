@@ -0,0 +1,447 @@
+#include "compression.hpp"
+
+#include <cerrno>
+#include <climits>
+
+#ifdef STDLIKE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef STDLIKE_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace stdlike {
+
+namespace {
+#ifdef STDLIKE_HAVE_ZLIB
+constexpr bool kHaveZlib = true;
+#else
+constexpr bool kHaveZlib = false;
+#endif
+#ifdef STDLIKE_HAVE_ZSTD
+constexpr bool kHaveZstd = true;
+#else
+constexpr bool kHaveZstd = false;
+#endif
+
+constexpr unsigned char kGzipMagic[] = {0x1f, 0x8b};
+constexpr unsigned char kZstdMagic[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+template <size_t N>
+bool starts_with(const char* data, size_t size, const unsigned char (&magic)[N]) {
+    return size >= N && memcmp(data, magic, N) == 0;
+}
+
+class identity_decoder : public decoder {
+public:
+    bool decode(const char*& input, const char* input_end, char*& output,
+                char* output_end) override {
+        size_t size = std::min(input_end - input, output_end - output);
+        memcpy(output, input, size);
+        input += size;
+        output += size;
+        return true;
+    }
+
+    bool finished() const override {
+        return true;
+    }
+};
+
+#ifdef STDLIKE_HAVE_ZLIB
+uInt zlib_size(const char* first, const char* last) {
+    return static_cast<uInt>(std::min<size_t>(last - first, UINT_MAX));
+}
+
+// Accepts gzip and zlib streams, including concatenated gzip members.
+class gzip_decoder : public decoder {
+public:
+    gzip_decoder() {
+        valid_ = inflateInit2(&stream_, 15 + 32) == Z_OK;
+    }
+
+    ~gzip_decoder() {
+        if (valid_) {
+            inflateEnd(&stream_);
+        }
+    }
+
+    bool valid() const {
+        return valid_;
+    }
+
+    bool decode(const char*& input, const char* input_end, char*& output,
+                char* output_end) override {
+        while (output != output_end) {
+            if (finished_) {
+                if (input == input_end) {
+                    break;
+                }
+                inflateReset(&stream_);
+                finished_ = false;
+            }
+            stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input));
+            stream_.avail_in = zlib_size(input, input_end);
+            stream_.next_out = reinterpret_cast<Bytef*>(output);
+            stream_.avail_out = zlib_size(output, output_end);
+            int result = inflate(&stream_, Z_NO_FLUSH);
+            input = reinterpret_cast<const char*>(stream_.next_in);
+            output = reinterpret_cast<char*>(stream_.next_out);
+            if (result == Z_STREAM_END) {
+                finished_ = true;
+            } else if (result == Z_BUF_ERROR) {
+                break;
+            } else if (result != Z_OK) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool finished() const override {
+        return finished_;
+    }
+
+private:
+    z_stream stream_{};
+    bool valid_;
+    bool finished_{false};
+};
+
+class gzip_encoder : public encoder {
+public:
+    explicit gzip_encoder(int level) {
+        valid_ = deflateInit2(&stream_, level < 0 ? Z_DEFAULT_COMPRESSION : level, Z_DEFLATED,
+                              15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+
+    ~gzip_encoder() {
+        if (valid_) {
+            deflateEnd(&stream_);
+        }
+    }
+
+    bool valid() const {
+        return valid_;
+    }
+
+    encode_status encode(const char*& input, const char* input_end, char*& output,
+                         char* output_end, flush_mode mode) override {
+        if (output == output_end) {
+            return encode_status::partial;
+        }
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input));
+        stream_.avail_in = zlib_size(input, input_end);
+        stream_.next_out = reinterpret_cast<Bytef*>(output);
+        stream_.avail_out = zlib_size(output, output_end);
+        int flush = mode == flush_mode::none   ? Z_NO_FLUSH
+                    : mode == flush_mode::sync ? Z_SYNC_FLUSH
+                                               : Z_FINISH;
+        int result = deflate(&stream_, flush);
+        input = reinterpret_cast<const char*>(stream_.next_in);
+        output = reinterpret_cast<char*>(stream_.next_out);
+        if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+            return encode_status::failed;
+        }
+        if (mode == flush_mode::finish) {
+            if (result != Z_STREAM_END) {
+                return encode_status::partial;
+            }
+            deflateReset(&stream_);
+            return encode_status::done;
+        }
+        bool done = input == input_end && (mode == flush_mode::none || output != output_end);
+        return done ? encode_status::done : encode_status::partial;
+    }
+
+private:
+    z_stream stream_{};
+    bool valid_;
+};
+#endif
+
+#ifdef STDLIKE_HAVE_ZSTD
+class zstd_decoder : public decoder {
+public:
+    zstd_decoder() : context_(ZSTD_createDCtx()) {
+    }
+
+    ~zstd_decoder() {
+        ZSTD_freeDCtx(context_);
+    }
+
+    bool valid() const {
+        return context_ != nullptr;
+    }
+
+    bool decode(const char*& input, const char* input_end, char*& output,
+                char* output_end) override {
+        ZSTD_inBuffer in{input, static_cast<size_t>(input_end - input), 0};
+        ZSTD_outBuffer out{output, static_cast<size_t>(output_end - output), 0};
+        size_t result = ZSTD_decompressStream(context_, &out, &in);
+        input += in.pos;
+        output += out.pos;
+        if (ZSTD_isError(result)) {
+            return false;
+        }
+        finished_ = result == 0;
+        return true;
+    }
+
+    bool finished() const override {
+        return finished_;
+    }
+
+private:
+    ZSTD_DCtx* context_;
+    bool finished_{false};
+};
+
+class zstd_encoder : public encoder {
+public:
+    explicit zstd_encoder(int level) : context_(ZSTD_createCCtx()) {
+        if (context_ != nullptr && level >= 0) {
+            ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel, level);
+        }
+    }
+
+    ~zstd_encoder() {
+        ZSTD_freeCCtx(context_);
+    }
+
+    bool valid() const {
+        return context_ != nullptr;
+    }
+
+    encode_status encode(const char*& input, const char* input_end, char*& output,
+                         char* output_end, flush_mode mode) override {
+        ZSTD_inBuffer in{input, static_cast<size_t>(input_end - input), 0};
+        ZSTD_outBuffer out{output, static_cast<size_t>(output_end - output), 0};
+        auto directive = mode == flush_mode::none   ? ZSTD_e_continue
+                         : mode == flush_mode::sync ? ZSTD_e_flush
+                                                    : ZSTD_e_end;
+        size_t result = ZSTD_compressStream2(context_, &out, &in, directive);
+        input += in.pos;
+        output += out.pos;
+        if (ZSTD_isError(result)) {
+            return encode_status::failed;
+        }
+        bool done = input == input_end && (mode == flush_mode::none || result == 0);
+        return done ? encode_status::done : encode_status::partial;
+    }
+
+private:
+    ZSTD_CCtx* context_;
+};
+#endif
+
+ssize_t corrupt() {
+    errno = EBADMSG;
+    return -1;
+}
+
+template <class Codec, class... Args>
+std::unique_ptr<Codec> make_valid(Args... args) {
+    auto codec = std::make_unique<Codec>(args...);
+    return codec->valid() ? std::move(codec) : nullptr;
+}
+}  // namespace
+
+std::unique_ptr<decoder> make_decoder(compression format) {
+    switch (format) {
+        case compression::none:
+            return std::make_unique<identity_decoder>();
+#ifdef STDLIKE_HAVE_ZLIB
+        case compression::gzip:
+            return make_valid<gzip_decoder>();
+#endif
+#ifdef STDLIKE_HAVE_ZSTD
+        case compression::zstd:
+            return make_valid<zstd_decoder>();
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+std::unique_ptr<encoder> make_encoder(compression format, [[maybe_unused]] int level) {
+    switch (format) {
+#ifdef STDLIKE_HAVE_ZLIB
+        case compression::gzip:
+            return make_valid<gzip_encoder>(level);
+#endif
+#ifdef STDLIKE_HAVE_ZSTD
+        case compression::zstd:
+            return make_valid<zstd_encoder>(level);
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+bool supports(compression format) {
+    switch (format) {
+        case compression::gzip:
+            return kHaveZlib;
+        case compression::zstd:
+            return kHaveZstd;
+        default:
+            return true;
+    }
+}
+
+filter_istream::filter_istream(int fd, compression format, size_t buffer_size)
+    : filter_istream(fd, format == compression::automatic ? nullptr : make_decoder(format),
+                     buffer_size) {
+    detect_ = format == compression::automatic;
+    error_ = decoder_ == nullptr && !detect_;
+}
+
+filter_istream::filter_istream(int fd, std::unique_ptr<decoder> filter, size_t buffer_size)
+    : istream(fd, buffer_size), decoder_(std::move(filter)),
+      raw_(utils::allocate_buffer(buffer_size)), raw_capacity_(std::max<size_t>(buffer_size, 1)),
+      detect_(false) {
+    error_ = decoder_ == nullptr;
+}
+
+ssize_t filter_istream::read_buffer(char* data, size_t size, long long) {
+    if (detect_ && !detect()) {
+        return -1;
+    }
+    if (decoder_ == nullptr) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    char* out = data;
+    while (true) {
+        const char* in = raw_.get() + raw_offset_;
+        if (!decoder_->decode(in, raw_.get() + raw_size_, out, data + size)) {
+            return corrupt();
+        }
+        size_t consumed = in - (raw_.get() + raw_offset_);
+        raw_offset_ += consumed;
+        if (out != data) {
+            return out - data;
+        }
+        if (raw_offset_ < raw_size_) {
+            if (consumed == 0) {
+                return corrupt();
+            }
+        } else if (raw_eof_) {
+            return decoder_->finished() ? 0 : corrupt();
+        } else if (!fill_raw()) {
+            return -1;
+        }
+    }
+}
+
+bool filter_istream::fill_raw() {
+    memmove(raw_.get(), raw_.get() + raw_offset_, raw_size_ - raw_offset_);
+    raw_size_ -= raw_offset_;
+    raw_offset_ = 0;
+    while (true) {
+        ssize_t read_size = read(fd_, raw_.get() + raw_size_, raw_capacity_ - raw_size_);
+        if (read_size == -1 && errno == EINTR) {
+            continue;
+        }
+        if (read_size == -1) {
+            return false;
+        }
+        raw_eof_ = read_size == 0;
+        raw_size_ += read_size;
+        return true;
+    }
+}
+
+bool filter_istream::detect() {
+    detect_ = false;
+    while (raw_size_ < sizeof(kZstdMagic) && !raw_eof_) {
+        if (!fill_raw()) {
+            return false;
+        }
+    }
+    compression format = starts_with(raw_.get(), raw_size_, kGzipMagic)   ? compression::gzip
+                         : starts_with(raw_.get(), raw_size_, kZstdMagic) ? compression::zstd
+                                                                          : compression::none;
+    decoder_ = make_decoder(format);
+    if (decoder_ == nullptr) {
+        errno = ENOTSUP;
+        return false;
+    }
+    return true;
+}
+
+filter_ostream::filter_ostream(int fd, compression format, int level, size_t buffer_size)
+    : filter_ostream(fd, make_encoder(format, level), buffer_size) {
+}
+
+filter_ostream::filter_ostream(int fd, std::unique_ptr<encoder> filter, size_t buffer_size)
+    : ostream(fd, buffer_size), encoder_(std::move(filter)),
+      raw_(utils::allocate_buffer(buffer_size)), raw_capacity_(std::max<size_t>(buffer_size, 1)) {
+    bypass_ = false;
+    error_ = encoder_ == nullptr;
+}
+
+filter_ostream::~filter_ostream() {
+    finish();
+}
+
+ostream& filter_ostream::flush() {
+    error_ = encoder_ == nullptr;
+    // A sync flush would start a compressed stream that nothing finishes.
+    if (started_ || offset_ != 0) {
+        encode(flush_mode::sync);
+    }
+    return *this;
+}
+
+filter_ostream& filter_ostream::finish() {
+    if (started_ || offset_ != 0) {
+        encode(flush_mode::finish);
+        started_ = false;
+    }
+    return *this;
+}
+
+void filter_ostream::write_buffer() {
+    encode(flush_mode::none);
+}
+
+void filter_ostream::encode(flush_mode mode) {
+    if (encoder_ == nullptr) {
+        offset_ = 0;
+        return;
+    }
+    started_ |= offset_ != 0;
+    const char* first = buffer_.get();
+    const char* last = first + offset_;
+    while (true) {
+        char* out = raw_.get() + raw_size_;
+        encode_status status = encoder_->encode(first, last, out, raw_.get() + raw_capacity_, mode);
+        raw_size_ = out - raw_.get();
+        if (status == encode_status::failed) {
+            error_ = true;
+            break;
+        }
+        if (status == encode_status::done) {
+            break;
+        }
+        write_raw();
+    }
+    offset_ = 0;
+    if (mode != flush_mode::none) {
+        write_raw();
+    }
+}
+
+void filter_ostream::write_raw() {
+    if (raw_size_ == 0) {
+        return;
+    }
+    iovec part{raw_.get(), raw_size_};
+    if (!utils::write_all(fd_, &part, 1)) {
+        error_ = true;
+    }
+    raw_size_ = 0;
+}
+}  // namespace stdlike
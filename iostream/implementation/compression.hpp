@@ -0,0 +1,106 @@
+#pragma once
+
+#include <memory>
+
+#include "iostream.hpp"
+
+namespace stdlike {
+
+// automatic picks gzip or zstd by the magic bytes of the input and passes anything else through.
+enum class compression { none, gzip, zstd, automatic };
+
+enum class flush_mode { none, sync, finish };
+
+// Streaming byte transform placed between a descriptor and a stream buffer. Each call consumes
+// a prefix of [input, input_end), fills a prefix of [output, output_end) and advances both.
+class decoder {
+public:
+    virtual ~decoder() = default;
+
+    // Returns false on corrupt input.
+    virtual bool decode(const char*& input, const char* input_end, char*& output,
+                        char* output_end) = 0;
+
+    // Whether the input decoded so far ends on a complete stream rather than a truncated one.
+    virtual bool finished() const = 0;
+};
+
+// done once the input is consumed and, for sync and finish, everything it produced has been
+// written to output; partial when output has to be drained first.
+enum class encode_status { partial, done, failed };
+
+class encoder {
+public:
+    virtual ~encoder() = default;
+
+    // finish also ends the stream, and later input starts a new one.
+    virtual encode_status encode(const char*& input, const char* input_end, char*& output,
+                                 char* output_end, flush_mode mode) = 0;
+};
+
+// nullptr when the format is not compiled in. automatic is resolved by filter_istream.
+std::unique_ptr<decoder> make_decoder(compression format);
+
+// level -1 is the default of the codec.
+std::unique_ptr<encoder> make_encoder(compression format, int level = -1);
+
+bool supports(compression format);
+
+// Input stream decoding fd in blocks of buffer_size bytes before the parsers see it.
+class filter_istream : public istream {
+public:
+    explicit filter_istream(int fd, compression format = compression::automatic,
+                            size_t buffer_size = kDefaultBufferSize);
+
+    filter_istream(int fd, std::unique_ptr<decoder> filter,
+                   size_t buffer_size = kDefaultBufferSize);
+
+protected:
+    ssize_t read_buffer(char* data, size_t size, long long position) override;
+
+private:
+    bool fill_raw();
+
+    bool detect();
+
+    std::unique_ptr<decoder> decoder_;
+    utils::buffer_ptr raw_;
+    size_t raw_capacity_;
+    size_t raw_offset_ = 0;
+    size_t raw_size_ = 0;
+    bool raw_eof_{false};
+    bool detect_;
+};
+
+// Output stream encoding its buffer on the way to fd. flush() makes everything written so far
+// decodable; finish() also ends the compressed stream and runs on destruction.
+class filter_ostream : public ostream {
+public:
+    explicit filter_ostream(int fd, compression format = compression::gzip, int level = -1,
+                            size_t buffer_size = kDefaultBufferSize);
+
+    filter_ostream(int fd, std::unique_ptr<encoder> filter,
+                   size_t buffer_size = kDefaultBufferSize);
+
+    ~filter_ostream();
+
+    ostream& flush() override;
+
+    filter_ostream& finish();
+
+protected:
+    void write_buffer() override;
+
+private:
+    void encode(flush_mode mode);
+
+    void write_raw();
+
+    std::unique_ptr<encoder> encoder_;
+    utils::buffer_ptr raw_;
+    size_t raw_capacity_;
+    size_t raw_size_ = 0;
+    // Whether the current compressed stream has data and needs finishing.
+    bool started_{false};
+};
+}  // namespace stdlike
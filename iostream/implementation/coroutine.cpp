@@ -0,0 +1,81 @@
+#include "coroutine.hpp"
+
+namespace stdlike {
+
+awaitable_istream::read_awaiter::read_awaiter(awaitable_istream& in) : in_(in) {
+}
+
+bool awaitable_istream::read_awaiter::await_ready() {
+    in_.clear();
+    result_ = in_.read_more();
+    return !in_.would_block();
+}
+
+bool awaitable_istream::read_awaiter::await_suspend(std::coroutine_handle<> awaiter) {
+    awaiter_ = awaiter;
+    return in_.loop_.wait(in_.fd(), EPOLLIN, [this] { on_readable(); });
+}
+
+ssize_t awaitable_istream::read_awaiter::await_resume() const {
+    return result_;
+}
+
+void awaitable_istream::read_awaiter::on_readable() {
+    in_.clear();
+    result_ = in_.read_more();
+    if (in_.would_block() && in_.loop_.wait(in_.fd(), EPOLLIN, [this] { on_readable(); })) {
+        return;
+    }
+    awaiter_.resume();
+}
+
+awaitable_istream::awaitable_istream(reactor& loop, int fd, size_t buffer_size)
+    : nonblocking_istream(fd, buffer_size), loop_(loop) {
+}
+
+awaitable_istream::read_awaiter awaitable_istream::read_some() {
+    return read_awaiter(*this);
+}
+
+reactor& awaitable_istream::loop() const {
+    return loop_;
+}
+
+awaitable_ostream::flush_awaiter::flush_awaiter(ostream& out)
+    : out_(out), target_(dynamic_cast<awaitable_ostream*>(&out)) {
+}
+
+bool awaitable_ostream::flush_awaiter::await_ready() const {
+    return target_ == nullptr || target_->pending() == 0 || target_->fail();
+}
+
+bool awaitable_ostream::flush_awaiter::await_suspend(std::coroutine_handle<> awaiter) {
+    awaiter_ = awaiter;
+    return target_->loop_.wait(target_->fd(), EPOLLOUT, [this] { on_writable(); });
+}
+
+ostream& awaitable_ostream::flush_awaiter::await_resume() const {
+    return out_;
+}
+
+void awaitable_ostream::flush_awaiter::on_writable() {
+    target_->flush();
+    if (!await_ready() &&
+        target_->loop_.wait(target_->fd(), EPOLLOUT, [this] { on_writable(); })) {
+        return;
+    }
+    awaiter_.resume();
+}
+
+awaitable_ostream::awaitable_ostream(reactor& loop, int fd, size_t buffer_size)
+    : nonblocking_ostream(fd, buffer_size), loop_(loop) {
+}
+
+reactor& awaitable_ostream::loop() const {
+    return loop_;
+}
+
+awaitable_ostream::flush_awaiter operator co_await(ostream& out) {
+    return awaitable_ostream::flush_awaiter(out);
+}
+}  // namespace stdlike
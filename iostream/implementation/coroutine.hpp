@@ -0,0 +1,224 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include "reactor.hpp"
+
+namespace stdlike {
+
+template <class T = void>
+class task;
+
+namespace detail {
+struct promise_base {
+    struct final_awaiter {
+        bool await_ready() noexcept {
+            return false;
+        }
+
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            promise_base& promise = handle.promise();
+            if (promise.continuation) {
+                return promise.continuation;
+            }
+            if (promise.detached) {
+                if (promise.exception) {
+                    std::terminate();
+                }
+                handle.destroy();
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {
+        }
+    };
+
+    std::suspend_always initial_suspend() noexcept {
+        return {};
+    }
+
+    final_awaiter final_suspend() noexcept {
+        return {};
+    }
+
+    void unhandled_exception() {
+        exception = std::current_exception();
+    }
+
+    void rethrow() const {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+    bool detached = false;
+};
+
+template <class T>
+struct promise : promise_base {
+    task<T> get_return_object();
+
+    void return_value(T result) {
+        value.emplace(std::move(result));
+    }
+
+    T take() {
+        rethrow();
+        return std::move(*value);
+    }
+
+    std::optional<T> value;
+};
+
+template <>
+struct promise<void> : promise_base {
+    task<void> get_return_object();
+
+    void return_void() {
+    }
+
+    void take() const {
+        rethrow();
+    }
+};
+}  // namespace detail
+
+// Lazily started coroutine: the body runs once the task is awaited or spawned, and the awaiter
+// resumes with its result, or its exception, when the body finishes.
+template <class T>
+class task {
+public:
+    using promise_type = detail::promise<T>;
+
+    explicit task(std::coroutine_handle<promise_type> handle) : handle_(handle) {
+    }
+
+    task(task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {
+    }
+
+    task& operator=(task other) noexcept {
+        std::swap(handle_, other.handle_);
+        return *this;
+    }
+
+    ~task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+
+    T await_resume() {
+        return handle_.promise().take();
+    }
+
+    // Starts work without an awaiter. The task owns itself from then on and is destroyed when
+    // it finishes; an exception escaping it terminates the program.
+    template <class U>
+    friend void spawn(task<U> work);
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <class T>
+void spawn(task<T> work) {
+    auto handle = std::exchange(work.handle_, nullptr);
+    handle.promise().detached = true;
+    handle.resume();
+}
+
+template <class T>
+task<T> detail::promise<T>::get_return_object() {
+    return task<T>(std::coroutine_handle<promise>::from_promise(*this));
+}
+
+inline task<void> detail::promise<void>::get_return_object() {
+    return task<void>(std::coroutine_handle<promise>::from_promise(*this));
+}
+
+// Non-blocking input stream whose reads suspend the awaiting coroutine on a reactor. Parse what
+// read_some() brought in with the usual operators; they fail with would_block() when the buffer
+// runs out, and the token they stopped in is read again after the next read_some().
+class awaitable_istream : public nonblocking_istream {
+public:
+    class read_awaiter {
+    public:
+        explicit read_awaiter(awaitable_istream& in);
+
+        bool await_ready();
+
+        bool await_suspend(std::coroutine_handle<> awaiter);
+
+        ssize_t await_resume() const;
+
+    private:
+        void on_readable();
+
+        awaitable_istream& in_;
+        std::coroutine_handle<> awaiter_;
+        ssize_t result_ = 0;
+    };
+
+    awaitable_istream(reactor& loop, int fd, size_t buffer_size = kDefaultBufferSize);
+
+    // Clears the stream state and reads what arrives after the unconsumed input, suspending until
+    // the descriptor is readable. Resumes with the number of bytes read, 0 at the end of the
+    // input and -1 on errors.
+    read_awaiter read_some();
+
+    reactor& loop() const;
+
+private:
+    reactor& loop_;
+};
+
+// Non-blocking output stream whose flushes can be awaited: co_await out.flush() suspends the
+// coroutine on a reactor until the descriptor took everything written so far.
+class awaitable_ostream : public nonblocking_ostream {
+public:
+    class flush_awaiter {
+    public:
+        explicit flush_awaiter(ostream& out);
+
+        bool await_ready() const;
+
+        bool await_suspend(std::coroutine_handle<> awaiter);
+
+        ostream& await_resume() const;
+
+    private:
+        void on_writable();
+
+        ostream& out_;
+        awaitable_ostream* target_;
+        std::coroutine_handle<> awaiter_;
+    };
+
+    awaitable_ostream(reactor& loop, int fd, size_t buffer_size = kDefaultBufferSize);
+
+    reactor& loop() const;
+
+private:
+    reactor& loop_;
+};
+
+// Waits for the queued output of an awaitable_ostream. Other streams flush synchronously, so
+// awaiting them resumes at once.
+awaitable_ostream::flush_awaiter operator co_await(ostream& out);
+}  // namespace stdlike
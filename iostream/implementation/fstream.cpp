@@ -0,0 +1,82 @@
+#include "fstream.hpp"
+
+namespace stdlike {
+
+namespace {
+int open_file(const char* path, int flags, mode_t mode) {
+    int fd = open(path, flags | O_CLOEXEC, mode);
+    if (fd == -1 && errno == EINVAL && (flags & O_DIRECT) != 0) {
+        fd = open(path, (flags & ~O_DIRECT) | O_CLOEXEC, mode);
+    }
+    return fd;
+}
+
+size_t direct_buffer_size(size_t buffer_size, int flags) {
+    if ((flags & O_DIRECT) == 0) {
+        return buffer_size;
+    }
+    return std::max<size_t>(1, (buffer_size + utils::kBufferAlignment - 1) /
+                                   utils::kBufferAlignment) *
+           utils::kBufferAlignment;
+}
+}  // namespace
+
+fd_istream::fd_istream(int fd, input_mode mode, size_t buffer_size)
+    : istream(fd, mode, buffer_size) {
+    error_ = fd < 0;
+}
+
+fd_istream::~fd_istream() {
+    close();
+}
+
+bool fd_istream::is_open() const {
+    return fd_ >= 0;
+}
+
+void fd_istream::close() {
+    if (is_open()) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool fd_istream::advise(int advice, off_t offset, off_t length) {
+    return is_open() && posix_fadvise(fd_, offset, length, advice) == 0;
+}
+
+ifstream::ifstream(const char* path, int flags, input_mode mode, size_t buffer_size, int advice)
+    : fd_istream(open_file(path, O_RDONLY | flags, 0), mode,
+                 direct_buffer_size(buffer_size, flags)) {
+    advise(advice);
+}
+
+fd_ostream::fd_ostream(int fd, size_t buffer_size) : ostream(fd, buffer_size) {
+    error_ = fd < 0;
+}
+
+fd_ostream::~fd_ostream() {
+    close();
+}
+
+bool fd_ostream::is_open() const {
+    return fd_ >= 0;
+}
+
+void fd_ostream::close() {
+    if (is_open()) {
+        flush();
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool fd_ostream::advise(int advice, off_t offset, off_t length) {
+    return is_open() && posix_fadvise(fd_, offset, length, advice) == 0;
+}
+
+ofstream::ofstream(const char* path, int flags, size_t buffer_size, mode_t mode)
+    : fd_ostream(open_file(path, O_WRONLY | O_CREAT | flags, mode),
+                 direct_buffer_size(buffer_size, flags)) {
+}
+}  // namespace stdlike
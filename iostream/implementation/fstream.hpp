@@ -0,0 +1,48 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "iostream.hpp"
+
+namespace stdlike {
+
+class fd_istream : public istream {
+public:
+    explicit fd_istream(int fd, input_mode mode = input_mode::buffered,
+                        size_t buffer_size = kDefaultBufferSize);
+
+    ~fd_istream();
+
+    bool is_open() const;
+
+    void close();
+
+    bool advise(int advice, off_t offset = 0, off_t length = 0);
+};
+
+class ifstream : public fd_istream {
+public:
+    explicit ifstream(const char* path, int flags = 0, input_mode mode = input_mode::buffered,
+                      size_t buffer_size = kDefaultBufferSize, int advice = POSIX_FADV_SEQUENTIAL);
+};
+
+class fd_ostream : public ostream {
+public:
+    explicit fd_ostream(int fd, size_t buffer_size = kDefaultBufferSize);
+
+    ~fd_ostream();
+
+    bool is_open() const;
+
+    void close();
+
+    bool advise(int advice, off_t offset = 0, off_t length = 0);
+};
+
+class ofstream : public fd_ostream {
+public:
+    explicit ofstream(const char* path, int flags = O_TRUNC,
+                      size_t buffer_size = kDefaultBufferSize, mode_t mode = 0644);
+};
+}  // namespace stdlike
@@ -1,36 +1,141 @@
 #include "iostream.hpp"
+
+#include <poll.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <limits>
-#include <iostream>
+#include <new>
+#include <utility>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 namespace stdlike {
 
-bool utils::isspace(char symbol) {
-    char spaces[6] = {' ', '\f', '\n', '\r', '\t', '\v'};
+void utils::buffer_deleter::operator()(char* data) const {
+    ::operator delete[](data, std::align_val_t{kBufferAlignment});
+}
 
-    for (char space : spaces) {
-        if (space == symbol) {
-            return true;
+utils::buffer_ptr utils::allocate_buffer(size_t size) {
+    auto* data = ::operator new[](std::max<size_t>(size, 1), std::align_val_t{kBufferAlignment});
+    return buffer_ptr(static_cast<char*>(data));
+}
+
+bool utils::drop_direct(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    return flags != -1 && (flags & O_DIRECT) != 0 && fcntl(fd, F_SETFL, flags & ~O_DIRECT) != -1;
+}
+
+bool utils::write_all(int fd, iovec* parts, int count) {
+    while (count > 0) {
+        if (parts->iov_len == 0) {
+            ++parts;
+            --count;
+            continue;
+        }
+        ssize_t written = writev(fd, parts, count);
+        if (written == -1) {
+            if (errno == EINTR || (errno == EINVAL && drop_direct(fd))) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                pollfd request{fd, POLLOUT, 0};
+                poll(&request, 1, -1);
+                continue;
+            }
+            return false;
+        }
+        auto left = static_cast<size_t>(written);
+        while (count > 0 && left >= parts->iov_len) {
+            left -= parts->iov_len;
+            ++parts;
+            --count;
+        }
+        if (count > 0) {
+            parts->iov_base = static_cast<char*>(parts->iov_base) + left;
+            parts->iov_len -= left;
+        }
+    }
+    return true;
+}
+
+namespace {
+#if defined(__AVX2__)
+inline uint32_t space_mask(const char* data) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    __m256i shifted = _mm256_sub_epi8(chunk, _mm256_set1_epi8('\t'));
+    __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+    __m256i space = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' '));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(control, space)));
+}
+constexpr ptrdiff_t kVectorSize = 32;
+constexpr uint32_t kFullMask = 0xFFFFFFFF;
+#elif defined(__SSE2__)
+inline uint32_t space_mask(const char* data) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8('\t'));
+    __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+    __m128i space = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(control, space)));
+}
+constexpr ptrdiff_t kVectorSize = 16;
+constexpr uint32_t kFullMask = 0xFFFF;
+#endif
+}  // namespace
+
+const char* utils::skip_spaces(const char* first, const char* last) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    for (; last - first >= kVectorSize; first += kVectorSize) {
+        uint32_t non_spaces = ~space_mask(first) & kFullMask;
+        if (non_spaces != 0) {
+            return first + std::countr_zero(non_spaces);
+        }
+    }
+#endif
+    while (first != last && isspace(*first)) {
+        ++first;
+    }
+    return first;
+}
+
+const char* utils::find_space(const char* first, const char* last) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    for (; last - first >= kVectorSize; first += kVectorSize) {
+        uint32_t spaces = space_mask(first);
+        if (spaces != 0) {
+            return first + std::countr_zero(spaces);
         }
     }
+#endif
+    while (first != last && !isspace(*first)) {
+        ++first;
+    }
+    return first;
+}
 
-    return false;
+istream::istream(int fd, size_t buffer_size)
+    : fd_(fd), storage_(utils::allocate_buffer(buffer_size)), buffer_(storage_.get()),
+      capacity_(std::max<size_t>(buffer_size, 1)), tied_(nullptr),
+      tied_to_cout_(fd == STDIN_FILENO) {
 }
-template <typename T>
-void utils::reverse(T* start, T* end) {
-    for (int i = 0; i < (end - start) / 2; ++i) {
-        T tmp = *(start + i);
-        *(start + i) = *(end - i - 1);
-        *(end - i - 1) = tmp;
+
+istream::istream(int fd, input_mode mode, size_t buffer_size) : istream(fd, buffer_size) {
+    if (mode == input_mode::mapped) {
+        map_file();
     }
 }
 
-template <typename T>
-T utils::abs(T value) {
-    return value > 0 ? value : -value;
+istream::~istream() {
+    if (is_mapped() && !borrowed_) {
+        munmap(buffer_, mapped_size_);
+    }
 }
 
 istream& istream::operator>>(bool& value) {
-    cout_ptr->flush();
+    flush_tied();
     int number;
     *this >> number;
     if (error_ != 0) {
@@ -42,19 +147,100 @@ istream& istream::operator>>(bool& value) {
     return *this;
 }
 
+istream& istream::operator>>(void*& value) {
+    int base = std::exchange(base_, 16);
+    uintptr_t address;
+    *this >> address;
+    base_ = base;
+    value = error_ ? nullptr : reinterpret_cast<void*>(address);
+    return *this;
+}
+
+istream& istream::operator>>(istream& (*manipulator)(istream&)) {
+    return manipulator(*this);
+}
+
 istream& istream::operator>>(char& value) {
     get(value);
     return *this;
 }
 
+istream& istream::operator>>(std::string& value) {
+    value = read_token();
+    return *this;
+}
+
+std::string_view istream::read_token() {
+    flush_tied();
+    skip_spaces();
+    if (nonblocking_ && !buffer_token()) {
+        error_ = true;
+        return {};
+    }
+    size_t length = 0;
+    if (buffer_size_ > 0) {
+        while (true) {
+            const char* first = buffer_ + offset_;
+            const char* last = buffer_ + buffer_size_;
+            const char* end = utils::find_space(first + length, last);
+            length = end - first;
+            if (end != last || !refill_tail()) {
+                break;
+            }
+        }
+    }
+    std::string_view token(buffer_ + offset_, length);
+    offset_ += length;
+    error_ = length == 0;
+    return token;
+}
+
+std::string_view istream::getline(char delim) {
+    flush_tied();
+    get_new_buffer();
+    if (buffer_size_ <= 0) {
+        error_ = true;
+        return {};
+    }
+    size_t length = 0;
+    size_t consumed = 0;
+    while (true) {
+        const char* first = buffer_ + offset_;
+        size_t available = buffer_size_ - offset_;
+        const void* end = memchr(first + length, delim, available - length);
+        if (end != nullptr) {
+            length = static_cast<const char*>(end) - first;
+            consumed = length + 1;
+            break;
+        }
+        length = consumed = available;
+        if (!refill_tail()) {
+            if (would_block_) {
+                error_ = true;
+                return {};
+            }
+            break;
+        }
+    }
+    std::string_view line(buffer_ + offset_, length);
+    offset_ += consumed;
+    error_ = false;
+    return line;
+}
+
+istream& istream::getline(std::string& line, char delim) {
+    line = getline(delim);
+    return *this;
+}
+
 istream& istream::get(char& symbol) {
     skip_spaces();
-    if (buffer_size_ == -1) {
+    if (buffer_size_ <= 0) {
         symbol = '\0';
         error_ = true;
         return *this;
     }
-    cout_ptr->flush();
+    flush_tied();
     symbol = peek();
     ++offset_;
     return *this;
@@ -73,7 +259,7 @@ void istream::get_new_buffer() {
         if (buffer_size_ > 0) {
             absolute_offset_ += static_cast<long long>(buffer_size_);
         }
-        buffer_size_ = pread(0, buffer_, kMaxBufferSize, absolute_offset_);
+        buffer_size_ = read_input(buffer_, capacity_, absolute_offset_);
         if (buffer_size_ <= 0) {
             error_ = 1;
         }
@@ -81,14 +267,252 @@ void istream::get_new_buffer() {
     }
 }
 
+ssize_t istream::read_buffer(char* data, size_t size, long long position) {
+    if (is_mapped()) {
+        return 0;
+    }
+    while (true) {
+        ssize_t read_size = seekable_ ? pread(fd_, data, size, position) : read(fd_, data, size);
+        if (read_size == -1 && errno == ESPIPE && seekable_) {
+            seekable_ = false;
+        } else if (read_size == -1 && errno == EINVAL && utils::drop_direct(fd_)) {
+            continue;
+        } else if (read_size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK) && !nonblocking_) {
+            pollfd request{fd_, POLLIN, 0};
+            poll(&request, 1, -1);
+        } else if (read_size != -1 || errno != EINTR) {
+            return read_size;
+        }
+    }
+}
+
+bool istream::refill_tail() {
+    if (is_mapped()) {
+        return false;
+    }
+    size_t left = offset_ < buffer_size_ ? buffer_size_ - offset_ : 0;
+    if (left == capacity_) {
+        capacity_ *= 2;
+        utils::buffer_ptr buffer = utils::allocate_buffer(capacity_);
+        memcpy(buffer.get(), buffer_ + offset_, left);
+        storage_ = std::move(buffer);
+        buffer_ = storage_.get();
+    } else {
+        memmove(buffer_, buffer_ + offset_, left);
+    }
+    absolute_offset_ += offset_;
+    buffer_size_ = static_cast<ssize_t>(left);
+    offset_ = 0;
+
+    ssize_t size = read_input(buffer_ + left, capacity_ - left, absolute_offset_ + left);
+    if (size <= 0) {
+        return false;
+    }
+    buffer_size_ += size;
+    return true;
+}
+
+ssize_t istream::read_more() {
+    ssize_t left = offset_ < buffer_size_ ? buffer_size_ - offset_ : 0;
+    if (!refill_tail()) {
+        return eof_ ? 0 : -1;
+    }
+    return buffer_size_ - left;
+}
+
+ssize_t istream::read_input(char* data, size_t size, long long position) {
+    if (eof_ || bad_ || would_block_) {
+        return eof_ ? 0 : -1;
+    }
+    ssize_t read_size = read_buffer(data, size, position);
+    if (read_size == 0) {
+        eof_ = true;
+    } else if (read_size < 0) {
+        would_block_ = errno == EAGAIN || errno == EWOULDBLOCK;
+        bad_ = !would_block_;
+    }
+    return read_size;
+}
+
+bool istream::buffer_token() {
+    size_t length = 0;
+    while (offset_ < buffer_size_) {
+        const char* first = buffer_ + offset_;
+        const char* last = buffer_ + buffer_size_;
+        const char* end = utils::find_space(first + length, last);
+        if (end != last) {
+            return true;
+        }
+        length = end - first;
+        if (!refill_tail()) {
+            break;
+        }
+    }
+    return !would_block_;
+}
+
+bool istream::map_file() {
+    struct stat info;
+    if (fstat(fd_, &info) == -1 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        return false;
+    }
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+    storage_.reset();
+    buffer_ = static_cast<char*>(mapping);
+    mapped_size_ = info.st_size;
+    capacity_ = mapped_size_;
+    buffer_size_ = static_cast<ssize_t>(mapped_size_);
+    return true;
+}
+
+void istream::view(const char* data, size_t size) {
+    storage_.reset();
+    buffer_ = const_cast<char*>(data);
+    mapped_size_ = size;
+    capacity_ = size;
+    buffer_size_ = static_cast<ssize_t>(size);
+    offset_ = 0;
+    borrowed_ = true;
+}
+
+int istream::fd() const {
+    return fd_;
+}
+
+bool istream::is_mapped() const {
+    return mapped_size_ != 0;
+}
+
+ostream* istream::tie() const {
+    return tied_to_cout_ ? &cout : tied_;
+}
+
+ostream* istream::tie(ostream* out) {
+    ostream* previous = tie();
+    tie_resolved_ = true;
+    tied_to_cout_ = false;
+    tied_ = out;
+    return previous;
+}
+
+void istream::flush_tied() {
+    if (!tie_resolved_) {
+        tie_resolved_ = true;
+        ostream* tied = tie();
+        if (tied != nullptr && isatty(tied->fd()) == 0) {
+            tied_ = nullptr;
+            tied_to_cout_ = false;
+        }
+    }
+    ostream* tied = tie();
+    if (tied != nullptr && !tied->empty()) {
+        tied->flush();
+    }
+}
+
+void istream::set_buffer_size(size_t buffer_size) {
+    if (is_mapped()) {
+        return;
+    }
+    size_t left = offset_ < buffer_size_ ? buffer_size_ - offset_ : 0;
+    capacity_ = std::max({buffer_size, left, size_t{1}});
+    utils::buffer_ptr buffer = utils::allocate_buffer(capacity_);
+    memcpy(buffer.get(), buffer_ + offset_, left);
+    storage_ = std::move(buffer);
+    buffer_ = storage_.get();
+    absolute_offset_ += offset_;
+    buffer_size_ = static_cast<ssize_t>(left);
+    offset_ = 0;
+}
+
+size_t istream::buffer_size() const {
+    return capacity_;
+}
+
+bool istream::read_digits(uint64_t& magnitude, bool& overflow, int base) {
+    bool any_digits = false;
+    while (true) {
+        if (base == 10 && std::endian::native == std::endian::little &&
+            buffer_size_ - offset_ >= 8) {
+            uint64_t chunk;
+            memcpy(&chunk, buffer_ + offset_, sizeof(chunk));
+            unsigned count = utils::count_digits_swar(chunk);
+            if (count == 0) {
+                break;
+            }
+            overflow |= __builtin_mul_overflow(magnitude, utils::kPowersOfTen[count], &magnitude);
+            overflow |= __builtin_add_overflow(magnitude, utils::parse_digits_swar(chunk, count),
+                                               &magnitude);
+            offset_ += count;
+            any_digits = true;
+            if (count < 8) {
+                break;
+            }
+        } else {
+            unsigned digit = utils::digit_value(static_cast<char>(peek()));
+            if (digit >= static_cast<unsigned>(base)) {
+                break;
+            }
+            overflow |= __builtin_mul_overflow(magnitude, uint64_t(base), &magnitude);
+            overflow |= __builtin_add_overflow(magnitude, uint64_t{digit}, &magnitude);
+            ++offset_;
+            any_digits = true;
+        }
+    }
+    return any_digits;
+}
+
+int istream::read_base_prefix() {
+    // The prefix takes up to three characters to tell apart, unless the token ends sooner.
+    while (!nonblocking_) {
+        const char* first = buffer_ + offset_;
+        const char* last = buffer_ + std::max(buffer_size_, offset_);
+        if (last - first >= 3 || utils::find_space(first, last) != last || !refill_tail()) {
+            break;
+        }
+    }
+    const char* first = buffer_ + offset_;
+    ssize_t available = std::max<ssize_t>(buffer_size_ - offset_, 0);
+    bool zero = available > 0 && first[0] == '0';
+    bool prefixed =
+        zero && available > 2 && (first[1] | 0x20) == 'x' && utils::digit_value(first[2]) < 16;
+    if (prefixed && (base_ == 0 || base_ == 16)) {
+        offset_ += 2;
+        return 16;
+    }
+    return base_ != 0 ? base_ : zero ? 8 : 10;
+}
+
 void istream::skip_spaces() {
-    while (!error_ && utils::isspace(peek())) {
-        ++offset_;
+    while (true) {
+        get_new_buffer();
+        if (buffer_size_ <= 0) {
+            return;
+        }
+        offset_ = utils::skip_spaces(buffer_ + offset_, buffer_ + buffer_size_) - buffer_;
+        if (offset_ < buffer_size_) {
+            return;
+        }
     }
 }
 
+ostream::ostream(int fd, size_t buffer_size)
+    : fd_(fd), buffer_(utils::allocate_buffer(buffer_size)),
+      capacity_(std::max<size_t>(buffer_size, 1)) {
+    int flags = fcntl(fd, F_GETFL);
+    bypass_ = flags == -1 || (flags & O_DIRECT) == 0;
+}
+
+ostream::~ostream() {
+    write_buffer();
+}
+
 ostream& ostream::operator<<(char value) {
-    if (offset_ >= kMaxBufferSize) {
+    if (offset_ >= capacity_) {
         write_buffer();
     }
     buffer_[offset_++] = value;
@@ -96,7 +520,22 @@ ostream& ostream::operator<<(char value) {
 }
 
 ostream& ostream::operator<<(const void* value) {
-    return *this << '0' << 'x' << reinterpret_cast<long long>(value);
+    auto address = reinterpret_cast<uintptr_t>(value);
+    size_t size = 2 + std::max<size_t>(1, (std::bit_width(address) + 3) / 4);
+    char local[2 + 2 * sizeof(uintptr_t)];
+    char* out = reserve(size);
+    char* target = out != nullptr ? out : local;
+    target[0] = '0';
+    target[1] = 'x';
+    for (size_t i = size; i > 2; --i, address >>= 4) {
+        target[i - 1] = "0123456789abcdef"[address & 15];
+    }
+    if (out != nullptr) {
+        offset_ += size;
+    } else {
+        write(local, size);
+    }
+    return *this;
 }
 
 ostream& ostream::operator<<(bool value) {
@@ -104,15 +543,38 @@ ostream& ostream::operator<<(bool value) {
 }
 
 ostream& ostream::operator<<(const char* value) {
-    while (*value != '\0') {
-        *this << *(value++);
-    }
+    return write(value, strlen(value));
+}
 
-    return *this;
+ostream& ostream::operator<<(ostream& (*manipulator)(ostream&)) {
+    return manipulator(*this);
 }
 
 ostream& ostream::put(char symbol) {
-    buffer_[offset_++] = symbol;
+    return *this << symbol;
+}
+
+ostream& ostream::write(const char* data, size_t size) {
+    if (size <= capacity_ - offset_) {
+        memcpy(buffer_.get() + offset_, data, size);
+        offset_ += size;
+        return *this;
+    }
+    if (size >= capacity_ / 2 && bypass_) {
+        iovec parts[2] = {{buffer_.get(), offset_}, {const_cast<char*>(data), size}};
+        write_all(parts, 2);
+        return *this;
+    }
+    while (size > 0) {
+        size_t chunk = std::min(size, capacity_ - offset_);
+        memcpy(buffer_.get() + offset_, data, chunk);
+        offset_ += chunk;
+        data += chunk;
+        size -= chunk;
+        if (offset_ == capacity_) {
+            write_buffer();
+        }
+    }
     return *this;
 }
 
@@ -122,19 +584,78 @@ ostream& ostream::flush() {
     return *this;
 }
 
-void ostream::write_buffer() {
-    ssize_t written = 0;
-    while (written != offset_) {
-        ssize_t last_written = write(1, buffer_ + written, offset_ - written);
-        if (last_written == -1) {
-            error_ = 1;
-            return;
+void ostream::set_buffer_size(size_t buffer_size) {
+    write_buffer();
+    capacity_ = std::max({buffer_size, offset_, size_t{1}});
+    utils::buffer_ptr buffer = utils::allocate_buffer(capacity_);
+    memcpy(buffer.get(), buffer_.get(), offset_);
+    buffer_ = std::move(buffer);
+}
+
+size_t ostream::buffer_size() const {
+    return capacity_;
+}
+
+int ostream::fd() const {
+    return fd_;
+}
+
+bool ostream::empty() const {
+    return offset_ == 0;
+}
+
+char* ostream::reserve(size_t size) {
+    if (capacity_ - offset_ < size) {
+        write_buffer();
+        if (capacity_ - offset_ < size) {
+            return nullptr;
         }
-        written += last_written;
+    }
+    return buffer_.get() + offset_;
+}
+
+void ostream::write_buffer() {
+    iovec part{buffer_.get(), offset_};
+    write_all(&part, 1);
+}
+
+void ostream::write_all(iovec* parts, int count) {
+    if (!utils::write_all(fd_, parts, count)) {
+        error_ = true;
     }
     offset_ = 0;
 }
 
+ostream& ostream::format(float_format format) {
+    format_ = format;
+    return *this;
+}
+
+float_format ostream::format() const {
+    return format_;
+}
+
+ostream& ostream::precision(int precision) {
+    precision_ = precision;
+    return *this;
+}
+
+int ostream::precision() const {
+    return precision_;
+}
+
+ostream& fixed(ostream& out) {
+    return out.format(float_format::fixed);
+}
+
+ostream& scientific(ostream& out) {
+    return out.format(float_format::scientific);
+}
+
+ostream& defaultfloat(ostream& out) {
+    return out.format(float_format::shortest);
+}
+
 bool ostream::fail() {
     return error_;
 }
@@ -143,6 +664,107 @@ bool istream::fail() {
     return error_;
 }
 
+bool istream::eof() const {
+    return eof_;
+}
+
+bool istream::bad() const {
+    return bad_;
+}
+
+bool istream::would_block() const {
+    return would_block_;
+}
+
+bool istream::good() const {
+    return !error_ && !eof_ && !bad_;
+}
+
+void istream::clear() {
+    error_ = eof_ = bad_ = would_block_ = false;
+}
+
+istream& istream::base(int base) {
+    if (base == 0 || (2 <= base && base <= 36)) {
+        base_ = base;
+    }
+    return *this;
+}
+
+int istream::base() const {
+    return base_;
+}
+
+istream& dec(istream& in) {
+    return in.base(10);
+}
+
+istream& hex(istream& in) {
+    return in.base(16);
+}
+
+istream& oct(istream& in) {
+    return in.base(8);
+}
+
+bool istream::set_nonblocking(bool nonblocking) {
+    int flags = fcntl(fd_, F_GETFL);
+    if (flags == -1) {
+        return false;
+    }
+    flags = nonblocking ? flags | O_NONBLOCK : flags & ~O_NONBLOCK;
+    if (fcntl(fd_, F_SETFL, flags) == -1) {
+        return false;
+    }
+    nonblocking_ = nonblocking;
+    return true;
+}
+
+record_ostream::record_ostream(int fd, record_mode mode, size_t buffer_size,
+                               size_t max_record_size)
+    : ostream(fd, buffer_size), mode_(mode), max_record_(std::max<size_t>(max_record_size, 1)) {
+    bypass_ = false;
+}
+
+record_ostream::~record_ostream() {
+    commit();
+}
+
+record_ostream& record_ostream::commit() {
+    ostream::write_buffer();
+    return *this;
+}
+
+ostream& record_ostream::flush() {
+    error_ = false;
+    return commit();
+}
+
+void record_ostream::write_buffer() {
+    const void* last = nullptr;
+    if (mode_ == record_mode::line) {
+        last = memrchr(buffer_.get(), '\n', offset_);
+    }
+    if (last != nullptr) {
+        size_t size = static_cast<const char*>(last) - buffer_.get() + 1;
+        size_t left = offset_ - size;
+        iovec part{buffer_.get(), size};
+        if (!utils::write_all(fd_, &part, 1)) {
+            error_ = true;
+        }
+        memmove(buffer_.get(), buffer_.get() + size, left);
+        offset_ = left;
+    }
+    if (offset_ >= max_record_) {
+        ostream::write_buffer();
+    } else if (offset_ > capacity_ / 2) {
+        utils::buffer_ptr buffer = utils::allocate_buffer(capacity_ * 2);
+        memcpy(buffer.get(), buffer_.get(), offset_);
+        buffer_ = std::move(buffer);
+        capacity_ *= 2;
+    }
+}
+
 istream cin;
-ostream cout;
+thread_local record_ostream cout;
 }  // namespace stdlike
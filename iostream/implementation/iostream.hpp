@@ -1,6 +1,26 @@
 #pragma once
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
 #include <type_traits>
 
 namespace concepts {
@@ -32,25 +52,212 @@ struct IsSignedType<T, false> : std::false_type {};
 
 template <typename T>
 concept IsSigned = requires(T value) { detail::IsSignedType<T>::value; };
+
+template <typename T>
+concept IsCharacter = std::same_as<T, char> || std::same_as<T, signed char> ||
+                      std::same_as<T, unsigned char> || std::same_as<T, char8_t> ||
+                      std::same_as<T, char16_t> || std::same_as<T, char32_t> ||
+                      std::same_as<T, wchar_t>;
 }  // namespace concepts
 
 namespace stdlike {
 
 namespace utils {
-bool isspace(char symbol);
+// Classes of kCharClasses, combinable into masks. Everything is ASCII and locale-free.
+inline constexpr uint8_t kSpaceClass = 1;
+inline constexpr uint8_t kDigitClass = 2;
+inline constexpr uint8_t kSignClass = 4;
+inline constexpr uint8_t kHexClass = 8;
+inline constexpr uint8_t kAlphaClass = 16;
+// Characters that may continue a number token, as in "1e+5" or "nan(0x1)".
+inline constexpr uint8_t kNumberClass = 32;
+
+inline constexpr auto kCharClasses = [] {
+    std::array<uint8_t, 256> classes{};
+    for (unsigned char space : {' ', '\f', '\n', '\r', '\t', '\v'}) {
+        classes[space] = kSpaceClass;
+    }
+    for (int symbol = '0'; symbol <= '9'; ++symbol) {
+        classes[symbol] = kDigitClass | kHexClass | kNumberClass;
+    }
+    for (int symbol = 'a'; symbol <= 'z'; ++symbol) {
+        uint8_t hex = symbol <= 'f' ? kHexClass : 0;
+        classes[symbol] = kAlphaClass | kNumberClass | hex;
+        classes[symbol - 'a' + 'A'] = kAlphaClass | kNumberClass | hex;
+    }
+    classes['+'] = classes['-'] = kSignClass | kNumberClass;
+    for (unsigned char symbol : {'.', '_', '(', ')'}) {
+        classes[symbol] = kNumberClass;
+    }
+    return classes;
+}();
+
+inline constexpr uint8_t kNotDigit = 0xFF;
+
+// Digit values for bases up to 36, kNotDigit for other characters.
+inline constexpr auto kDigitValues = [] {
+    std::array<uint8_t, 256> values{};
+    values.fill(kNotDigit);
+    for (int digit = 0; digit < 36; ++digit) {
+        int symbol = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        values[symbol] = static_cast<uint8_t>(digit);
+        values[digit < 10 ? symbol : symbol - 'a' + 'A'] = static_cast<uint8_t>(digit);
+    }
+    return values;
+}();
+
+constexpr bool has_class(char symbol, uint8_t classes) {
+    return (kCharClasses[static_cast<unsigned char>(symbol)] & classes) != 0;
+}
+
+constexpr bool isspace(char symbol) {
+    return has_class(symbol, kSpaceClass);
+}
+
+constexpr bool isdigit(char symbol) {
+    return has_class(symbol, kDigitClass);
+}
+
+constexpr bool is_number_char(char symbol) {
+    return has_class(symbol, kNumberClass);
+}
+
+// Value of symbol as a digit; digit_value(symbol) < base both checks and converts.
+constexpr unsigned digit_value(char symbol) {
+    return kDigitValues[static_cast<unsigned char>(symbol)];
+}
+
+inline constexpr size_t kBufferAlignment = 4096;
+
+struct buffer_deleter {
+    void operator()(char* data) const;
+};
+
+using buffer_ptr = std::unique_ptr<char[], buffer_deleter>;
+
+// Page-aligned storage, so buffers can be handed to O_DIRECT descriptors.
+buffer_ptr allocate_buffer(size_t size);
+
+// Clears O_DIRECT on fd, returning whether it was set. Used to retry unaligned transfers.
+bool drop_direct(int fd);
+
+// Writes every part, retrying EINTR and short writes. Returns false on a write error.
+bool write_all(int fd, iovec* parts, int count);
+
+// First non-space character in [first, last), or last.
+const char* skip_spaces(const char* first, const char* last);
+
+// First space character in [first, last), or last.
+const char* find_space(const char* first, const char* last);
 
 template <typename T>
-T abs(T value);
+T abs(T value) {
+    return value > 0 ? value : -value;
+}
 
 template <typename T>
-void reverse(T* start, T* end);
+void reverse(T* start, T* end) {
+    for (int i = 0; i < (end - start) / 2; ++i) {
+        T tmp = *(start + i);
+        *(start + i) = *(end - i - 1);
+        *(end - i - 1) = tmp;
+    }
+}
+
+inline constexpr auto kDigitPairs = [] {
+    std::array<char, 200> pairs{};
+    for (int i = 0; i < 100; ++i) {
+        pairs[2 * i] = static_cast<char>('0' + i / 10);
+        pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+    }
+    return pairs;
+}();
+
+inline constexpr auto kPowersOfTen = [] {
+    std::array<uint64_t, 20> powers{};
+    powers[0] = 1;
+    for (size_t i = 1; i < powers.size(); ++i) {
+        powers[i] = powers[i - 1] * 10;
+    }
+    return powers;
+}();
+
+template <std::unsigned_integral T>
+unsigned count_digits(T value) {
+    if constexpr (sizeof(T) <= sizeof(uint64_t)) {
+        uint64_t number = static_cast<uint64_t>(value) | 1;
+        unsigned guess = (static_cast<unsigned>(std::bit_width(number)) * 1233) >> 12;
+        return guess + 1 - (number < kPowersOfTen[guess]);
+    } else {
+        unsigned digits = 1;
+        while (value >= 10) {
+            value /= 10;
+            ++digits;
+        }
+        return digits;
+    }
+}
+
+// Number of leading ASCII digits among the 8 bytes of a little-endian loaded chunk.
+inline unsigned count_digits_swar(uint64_t chunk) {
+    uint64_t values = chunk ^ 0x3030303030303030;
+    uint64_t non_digits =
+        (((values & 0x7F7F7F7F7F7F7F7F) + 0x7676767676767676) | values) & 0x8080808080808080;
+    return static_cast<unsigned>(std::countr_zero(non_digits)) / 8;
+}
+
+// Value of the first count (1..8) digits of a little-endian loaded chunk.
+inline uint64_t parse_digits_swar(uint64_t chunk, unsigned count) {
+    uint64_t values = (chunk & 0x0F0F0F0F0F0F0F0F) << (8 * (8 - count));
+    values = (values * 2561) >> 8;
+    values = ((values & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+    return ((values & 0x0000FFFF0000FFFF) * 42949672960001) >> 32;
+}
+
+// Writes the decimal digits of value so that the last one lands right before end.
+template <std::unsigned_integral T>
+void format_digits(T value, char* end) {
+    while (value >= 100) {
+        size_t index = static_cast<size_t>(value % 100) * 2;
+        value /= 100;
+        *--end = kDigitPairs[index + 1];
+        *--end = kDigitPairs[index];
+    }
+    if (value >= 10) {
+        size_t index = static_cast<size_t>(value) * 2;
+        *--end = kDigitPairs[index + 1];
+        *--end = kDigitPairs[index];
+    } else {
+        *--end = static_cast<char>('0' + value);
+    }
+}
 }  // namespace utils
 
 class ostream;
-extern ostream cout;
+
+namespace detail {
+struct print_access;
+struct binary_access;
+struct parallel_access;
+}  // namespace detail
+
+enum class input_mode { buffered, mapped };
+
+enum class float_format { shortest, fixed, scientific };
 
 class istream {
 public:
+    static constexpr size_t kDefaultBufferSize = 1 << 16;
+
+    explicit istream(int fd = STDIN_FILENO, size_t buffer_size = kDefaultBufferSize);
+
+    istream(int fd, input_mode mode, size_t buffer_size = kDefaultBufferSize);
+
+    istream(const istream&) = delete;
+    istream& operator=(const istream&) = delete;
+
+    virtual ~istream();
+
     template <concepts::IsIntegrallyProcessed T>
     istream& operator>>(T& value);
 
@@ -62,31 +269,159 @@ public:
 
     istream& operator>>(char& value);
 
+    istream& operator>>(std::string& value);
+
+    // Hexadecimal address with an optional 0x prefix, as written by ostream.
+    istream& operator>>(void*& value);
+
+    istream& operator>>(istream& (*manipulator)(istream&));
+
     istream& get(char& symbol);
 
+    // Reads values.size() values as if by >>, stopping at the first failure. Tokens that lie
+    // wholly inside the buffer are parsed without the per-value refill and tie checks.
+    template <class T, size_t Extent>
+    istream& read_n(std::span<T, Extent> values);
+
+    // Next whitespace-separated token. The view points into the buffer and stays valid until
+    // the next read from the stream.
+    std::string_view read_token();
+
+    // Next line without the delimiter, with the same lifetime as read_token().
+    std::string_view getline(char delim = '\n');
+
+    istream& getline(std::string& line, char delim = '\n');
+
     int peek();
 
+    void set_buffer_size(size_t buffer_size);
+
+    size_t buffer_size() const;
+
+    bool is_mapped() const;
+
+    ostream* tie() const;
+
+    ostream* tie(ostream* out);
+
+    int fd() const;
+
     bool fail();
 
+    // Whether a read reached the end of the input. Later reads fail without another syscall
+    // until clear().
+    bool eof() const;
+
+    // Whether a read failed with an I/O error.
+    bool bad() const;
+
+    // Whether the last failed read found no data on a non-blocking descriptor.
+    bool would_block() const;
+
+    bool good() const;
+
+    void clear();
+
+    // Sets O_NONBLOCK on the descriptor. Reads that would block then fail with would_block() and
+    // leave the token they stopped in unconsumed, so it can be read again after clear(). In
+    // blocking mode EAGAIN waits for input instead.
+    bool set_nonblocking(bool nonblocking);
+
+    // Base of integer input, 2 to 36; base 16 allows a 0x prefix. Base 0 picks the base of each
+    // number from its prefix as strtol does: 0x for hexadecimal, 0 for octal. Other values are
+    // ignored.
+    istream& base(int base);
+
+    int base() const;
+
+protected:
+    // Reads up to size bytes of the input starting at position into data. Errors return -1
+    // with errno set.
+    virtual ssize_t read_buffer(char* data, size_t size, long long position);
+
+    // Reads once after the unconsumed input, growing the buffer if it is full. Returns the number
+    // of bytes read, 0 at the end of the input and -1 on errors or when the read would block.
+    ssize_t read_more();
+
+    // Parses [data, data + size) in place, as if it were a mapped file. The memory must outlive
+    // the stream and is never written to.
+    void view(const char* data, size_t size);
+
+    int fd_;
+    bool error_{false};
+    utils::buffer_ptr storage_;
+    char* buffer_;
+    size_t capacity_;
+
 private:
+    friend struct detail::binary_access;
+    friend struct detail::parallel_access;
+
+    void flush_tied();
+
     void get_new_buffer();
 
+    bool refill_tail();
+
+    // read_buffer() behind the eof, bad and would-block states.
+    ssize_t read_input(char* data, size_t size, long long position);
+
+    // Makes the token at offset_ end inside the buffer, or at the end of the input.
+    bool buffer_token();
+
+    bool map_file();
+
+    bool read_digits(uint64_t& magnitude, bool& overflow, int base = 10);
+
+    // Skips the prefix base() allows at offset_ and returns the base of the digits after it.
+    int read_base_prefix();
+
+    // Floating tokens are buffered whole only up to this length, so a run of letters after a
+    // number cannot make the buffer grow without bound.
+    static constexpr ssize_t kMaxNumberLength = 1 << 12;
+
+    template <std::floating_point T>
+    bool read_floating(T& value);
+
+    template <class T>
+    bool parse_buffered(T& value);
+
     void skip_spaces();
 
-    static constexpr size_t kMaxBufferSize = 128;
-    char buffer_[kMaxBufferSize];
+    size_t mapped_size_ = 0;
+    // Whether the mapped buffer belongs to someone else, see view().
+    bool borrowed_{false};
     ssize_t buffer_size_ = 0;
     ssize_t offset_ = 0;
     long long absolute_offset_ = 0;
-    bool error_{false};
-    ostream* cout_ptr = &cout;
+    bool seekable_{true};
+    bool eof_{false};
+    bool bad_{false};
+    bool would_block_{false};
+    bool nonblocking_{false};
+    int base_ = 10;
+    ostream* tied_;
+    // Tied to the cout of the reading thread, as cout is thread_local.
+    bool tied_to_cout_;
+    bool tie_resolved_{false};
 };
 
+istream& dec(istream& in);
+
+istream& hex(istream& in);
+
+istream& oct(istream& in);
+
 class ostream {
 public:
-    ~ostream() {
-        write_buffer();
-    }
+    static constexpr size_t kDefaultBufferSize = 1 << 16;
+
+    explicit ostream(int fd = STDOUT_FILENO, size_t buffer_size = kDefaultBufferSize);
+
+    ostream(const ostream&) = delete;
+    ostream& operator=(const ostream&) = delete;
+
+    virtual ~ostream();
 
     template <concepts::IsIntegrallyProcessed T>
     ostream& operator<<(T value);
@@ -103,44 +438,149 @@ public:
 
     ostream& operator<<(const char* value);
 
+    ostream& operator<<(ostream& (*manipulator)(ostream&));
+
     ostream& put(char symbol);
 
-    ostream& flush();
+    ostream& write(const char* data, size_t size);
+
+    // Writes the elements of range as if by <<, with separator between them.
+    template <std::ranges::input_range R>
+    ostream& write_range(R&& range, std::string_view separator = " ");
+
+    virtual ostream& flush();
+
+    void set_buffer_size(size_t buffer_size);
+
+    size_t buffer_size() const;
+
+    int fd() const;
+
+    bool empty() const;
+
+    ostream& format(float_format format);
+
+    float_format format() const;
+
+    ostream& precision(int precision);
+
+    int precision() const;
 
     bool fail();
 
+protected:
+    // Hands the filled part of buffer_ to the sink and leaves the buffer empty.
+    virtual void write_buffer();
+
+    int fd_;
+    bool error_{false};
+    utils::buffer_ptr buffer_;
+    size_t capacity_;
+    size_t offset_ = 0;
+    // Whether large writes may skip the buffer and go straight to writev.
+    bool bypass_{true};
+
 private:
-    void write_buffer();
+    friend struct detail::print_access;
+    friend struct detail::binary_access;
 
-    static constexpr ssize_t kMaxBufferSize = 128;
-    char buffer_[kMaxBufferSize];
-    ssize_t offset_ = 0;
+    template <std::floating_point T>
+    void write_floating(T value);
 
-    static const unsigned kDoublePrecision = 16;
-    bool error_{false};
+    void write_all(iovec* parts, int count);
+
+    char* reserve(size_t size);
+
+    static constexpr size_t kFloatingReserve = 64;
+    float_format format_ = float_format::shortest;
+    int precision_ = -1;
+};
+
+ostream& fixed(ostream& out);
+
+ostream& scientific(ostream& out);
+
+ostream& defaultfloat(ostream& out);
+
+enum class record_mode { line, commit };
+
+// Output stream that only hands complete records to the descriptor, each batch with a single
+// write. A record ends with '\n' in line mode, or at commit() in commit mode. A record that
+// outgrows the buffer grows it instead of being split, up to max_record_size bytes; longer
+// records are written in pieces as they come.
+class record_ostream : public ostream {
+public:
+    static constexpr size_t kDefaultMaxRecordSize = 1 << 20;
+
+    explicit record_ostream(int fd = STDOUT_FILENO, record_mode mode = record_mode::line,
+                            size_t buffer_size = kDefaultBufferSize,
+                            size_t max_record_size = kDefaultMaxRecordSize);
+
+    ~record_ostream();
+
+    // Ends the current record and writes everything buffered.
+    record_ostream& commit();
+
+    ostream& flush() override;
+
+protected:
+    void write_buffer() override;
+
+private:
+    record_mode mode_;
+    size_t max_record_;
 };
 
 extern istream cin;
 
+// Every thread writes through its own buffer, so lines from different threads never interleave.
+extern thread_local record_ostream cout;
+
 template <concepts::IsIntegrallyProcessed T>
 istream& istream::operator>>(T& value) {
-    cout_ptr->flush();
+    flush_tied();
     skip_spaces();
     error_ = true;
     value = 0;
-
-    short minus = 1;
-    if (peek() == '-') {
-        ++offset_;
-        if constexpr (concepts::IsSigned<T>) {
-            minus = -1;
-        }
+    if (nonblocking_ && !buffer_token()) {
+        return *this;
     }
 
-    while ('0' <= peek() && peek() <= '9') {
-        value = value * 10 + minus * (peek() - '0');
+    bool negative = peek() == '-';
+    if (negative) {
         ++offset_;
-        error_ = false;
+    }
+    int base = base_ == 10 ? 10 : read_base_prefix();
+
+    if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(uint64_t)) {
+        using Unsigned = std::make_unsigned_t<T>;
+        uint64_t magnitude = 0;
+        bool overflow = false;
+        if (read_digits(magnitude, overflow, base)) {
+            uint64_t limit = std::numeric_limits<T>::max();
+            if constexpr (std::is_signed_v<T>) {
+                limit += negative;
+            }
+            if (overflow || magnitude > limit) {
+                value = negative && std::is_signed_v<T> ? std::numeric_limits<T>::min()
+                                                        : std::numeric_limits<T>::max();
+                return *this;
+            }
+            auto result = static_cast<Unsigned>(magnitude);
+            value = static_cast<T>(negative ? static_cast<Unsigned>(Unsigned(0) - result) : result);
+            error_ = false;
+        }
+    } else {
+        int minus = negative ? -1 : 1;
+        while (true) {
+            unsigned digit = utils::digit_value(static_cast<char>(peek()));
+            if (digit >= static_cast<unsigned>(base)) {
+                break;
+            }
+            value = value * base + minus * static_cast<int>(digit);
+            ++offset_;
+            error_ = false;
+        }
     }
 
     return *this;
@@ -150,52 +590,185 @@ template <concepts::IsFloatingProcessed T>
 istream& istream::operator>>(T& value)
     requires(!concepts::IsIntegrallyProcessed<T>)
 {
-    cout_ptr->flush();
+    flush_tied();
     skip_spaces();
-    T minus = 1;
-    if (peek() == '-') {
-        ++offset_;
-        minus = -1;
+    if (nonblocking_ && !buffer_token()) {
+        error_ = true;
+        value = 0;
+        return *this;
     }
-    value = 0;
-    while ('0' <= peek() && peek() <= '9') {
-        value = value * 10 + peek() - '0';
+    if (peek() == '+') {
         ++offset_;
     }
-    if (peek() == '.') {
-        ++offset_;
-        double index = 10;
+    if constexpr (std::is_floating_point_v<T>) {
+        error_ = !read_floating(value);
+    } else {
+        double result;
+        error_ = !read_floating(result);
+        value = static_cast<T>(result);
+    }
+    return *this;
+}
 
-        while ('0' <= peek() && peek() <= '9') {
-            value += static_cast<double>(peek() - '0') / (index);
-            index *= 10;
-            ++offset_;
+template <std::floating_point T>
+bool istream::read_floating(T& value) {
+    get_new_buffer();
+    while (true) {
+        const char* first = buffer_ + offset_;
+        const char* last = buffer_ + std::max<ssize_t>(buffer_size_, offset_);
+        auto [end, error] = std::from_chars(first, last, value);
+        ssize_t length = end - first;
+        if (last - first < kMaxNumberLength && std::all_of(end, last, utils::is_number_char) &&
+            refill_tail()) {
+            continue;
+        }
+        first = buffer_ + offset_;
+        offset_ += length;
+        if (error == std::errc::result_out_of_range) {
+            std::string token(first, length);
+            if constexpr (std::is_same_v<T, float>) {
+                value = std::strtof(token.c_str(), nullptr);
+            } else if constexpr (std::is_same_v<T, double>) {
+                value = std::strtod(token.c_str(), nullptr);
+            } else {
+                value = std::strtold(token.c_str(), nullptr);
+            }
+            return false;
+        }
+        if (error != std::errc{}) {
+            value = 0;
+            return false;
+        }
+        return true;
+    }
+}
+
+template <class T, size_t Extent>
+istream& istream::read_n(std::span<T, Extent> values) {
+    flush_tied();
+    for (T& value : values) {
+        if (!parse_buffered(value)) {
+            *this >> value;
+            if (error_) {
+                break;
+            }
         }
     }
-    value *= minus;
     return *this;
 }
 
+// Parses the next value only when it and the character ending it are already buffered and
+// nothing unusual (overflow, '+', a range error) needs the general path. Leaves the stream
+// untouched on false.
+template <class T>
+bool istream::parse_buffered(T& value) {
+    const char* last = buffer_ + buffer_size_;
+    const char* first = buffer_ + offset_;
+    if (offset_ >= buffer_size_) {
+        return false;
+    }
+    while (first != last && utils::isspace(*first)) {
+        ++first;
+    }
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                  !concepts::IsCharacter<T> && sizeof(T) <= sizeof(uint64_t) &&
+                  std::endian::native == std::endian::little) {
+        if (base_ != 10) {
+            return false;
+        }
+        bool negative = first != last && *first == '-';
+        const char* digits = first + negative;
+        const char* current = digits;
+        uint64_t magnitude = 0;
+        while (true) {
+            if (last - current < 8) {
+                return false;
+            }
+            uint64_t chunk;
+            memcpy(&chunk, current, sizeof(chunk));
+            unsigned count = utils::count_digits_swar(chunk);
+            if (count == 0) {
+                break;
+            }
+            if (__builtin_mul_overflow(magnitude, utils::kPowersOfTen[count], &magnitude) ||
+                __builtin_add_overflow(magnitude, utils::parse_digits_swar(chunk, count),
+                                       &magnitude)) {
+                return false;
+            }
+            current += count;
+            if (count < 8) {
+                break;
+            }
+        }
+        uint64_t limit = std::numeric_limits<T>::max();
+        if constexpr (std::is_signed_v<T>) {
+            limit += negative;
+        } else if (negative) {
+            return false;
+        }
+        if (current == digits || magnitude > limit) {
+            return false;
+        }
+        using Unsigned = std::make_unsigned_t<T>;
+        auto result = static_cast<Unsigned>(magnitude);
+        value = static_cast<T>(negative ? static_cast<Unsigned>(Unsigned(0) - result) : result);
+        offset_ = current - buffer_;
+        error_ = false;
+        return true;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        T result;
+        auto [end, error] = std::from_chars(first, last, result);
+        if (error != std::errc{} || end == last || utils::is_number_char(*end)) {
+            return false;
+        }
+        value = result;
+        offset_ = end - buffer_;
+        error_ = false;
+        return true;
+    } else {
+        return false;
+    }
+}
+
 template <concepts::IsIntegrallyProcessed T>
 ostream& ostream::operator<<(T value) {
-    char* buffer = new char[30];
-    size_t offset = 0;
-
-    if (value < 0) {
-        buffer[offset++] = '-';
-    } else if (value == 0) {
-        buffer[offset++] = '0';
-    }
+    if constexpr (std::is_integral_v<T>) {
+        using Unsigned = std::make_unsigned_t<T>;
+        auto magnitude = static_cast<Unsigned>(value);
+        bool negative = false;
+        if constexpr (std::is_signed_v<T>) {
+            if (value < 0) {
+                negative = true;
+                magnitude = static_cast<Unsigned>(Unsigned(0) - magnitude);
+            }
+        }
+        size_t size = utils::count_digits(magnitude) + negative;
+        char local[48];
+        char* out = reserve(size);
+        char* target = out != nullptr ? out : local;
+        target[0] = '-';
+        utils::format_digits(magnitude, target + size);
+        if (out != nullptr) {
+            offset_ += size;
+        } else {
+            write(local, size);
+        }
+    } else {
+        std::string buffer;
+        if (value < 0) {
+            buffer.push_back('-');
+        } else if (value == 0) {
+            buffer.push_back('0');
+        }
 
-    size_t start_offset = offset;
-    while (value != 0) {
-        buffer[offset++] = static_cast<char>('0' + utils::abs(value % 10));
-        value /= 10;
+        size_t start_offset = buffer.size();
+        while (value != 0) {
+            buffer.push_back(static_cast<char>('0' + utils::abs(value % 10)));
+            value /= 10;
+        }
+        utils::reverse(buffer.data() + start_offset, buffer.data() + buffer.size());
+        write(buffer.data(), buffer.size());
     }
-    utils::reverse(buffer + start_offset, buffer + offset);
-    *(buffer + offset) = '\0';
-    operator<<(buffer);
-    delete[] buffer;
     return *this;
 }
 
@@ -203,17 +776,80 @@ template <concepts::IsFloatingProcessed T>
 ostream& ostream::operator<<(T value)
     requires(!concepts::IsIntegrallyProcessed<T>)
 {
-    *this << static_cast<long long>(value);
-    *this << '.';
-    value -= static_cast<double>(static_cast<long long>(value));
-    unsigned index = 0;
-    while (index++ < kDoublePrecision && value > 0) {
-        value *= 10;
-        int digit = static_cast<int>(value);
-        *this << digit;
-        value -= digit;
+    if constexpr (std::is_floating_point_v<T>) {
+        write_floating(value);
+    } else {
+        write_floating(static_cast<double>(value));
     }
+    return *this;
+}
 
+template <std::floating_point T>
+void ostream::write_floating(T value) {
+    auto convert = [this, value](char* first, char* last) {
+        if (format_ == float_format::shortest) {
+            return precision_ < 0 ? std::to_chars(first, last, value)
+                                  : std::to_chars(first, last, value, std::chars_format::general,
+                                                  precision_);
+        }
+        auto chars_format = format_ == float_format::fixed ? std::chars_format::fixed
+                                                           : std::chars_format::scientific;
+        return std::to_chars(first, last, value, chars_format, precision_ < 0 ? 6 : precision_);
+    };
+
+    if (char* out = reserve(kFloatingReserve); out != nullptr) {
+        auto [end, error] = convert(out, buffer_.get() + capacity_);
+        if (error == std::errc{}) {
+            offset_ = end - buffer_.get();
+            return;
+        }
+    }
+    std::string buffer(kFloatingReserve, '\0');
+    while (true) {
+        buffer.resize(buffer.size() * 2);
+        auto [end, error] = convert(buffer.data(), buffer.data() + buffer.size());
+        if (error == std::errc{}) {
+            write(buffer.data(), end - buffer.data());
+            return;
+        }
+    }
+}
+
+template <std::ranges::input_range R>
+ostream& ostream::write_range(R&& range, std::string_view separator) {
+    using T = std::remove_cvref_t<std::ranges::range_reference_t<R>>;
+    bool first = true;
+    for (auto&& value : range) {
+        size_t prefix = first ? 0 : separator.size();
+        first = false;
+        if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                      !concepts::IsCharacter<T> && sizeof(T) <= sizeof(uint64_t)) {
+            using Unsigned = std::make_unsigned_t<T>;
+            auto magnitude = static_cast<Unsigned>(value);
+            bool negative = false;
+            if constexpr (std::is_signed_v<T>) {
+                negative = value < 0;
+                if (negative) {
+                    magnitude = static_cast<Unsigned>(Unsigned(0) - magnitude);
+                }
+            }
+            size_t size = prefix + utils::count_digits(magnitude) + negative;
+            char* out = capacity_ - offset_ >= size ? buffer_.get() + offset_ : reserve(size);
+            if (out != nullptr) {
+                if (prefix == 1) {
+                    *out = separator[0];
+                } else {
+                    memcpy(out, separator.data(), prefix);
+                }
+                out[prefix] = '-';
+                utils::format_digits(magnitude, out + size);
+                offset_ += size;
+                continue;
+            }
+        }
+        write(separator.data(), prefix);
+        *this << value;
+    }
     return *this;
 }
-}  // namespace stdlike
\ No newline at end of file
+}  // namespace stdlike
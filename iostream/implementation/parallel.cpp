@@ -0,0 +1,100 @@
+#include "parallel.hpp"
+
+#include <atomic>
+
+namespace stdlike {
+
+memory_istream::memory_istream(std::string_view data) : istream(-1, 1), data_(data) {
+    if (!data.empty()) {
+        view(data.data(), data.size());
+    }
+}
+
+memory_istream::memory_istream(std::string_view data, size_t buffer_size)
+    : istream(-1, std::min(buffer_size, std::max<size_t>(data.size(), 1))), data_(data) {
+}
+
+ssize_t memory_istream::read_buffer(char* data, size_t size, long long position) {
+    if (position < 0 || static_cast<size_t>(position) >= data_.size()) {
+        return 0;
+    }
+    size = std::min(size, data_.size() - static_cast<size_t>(position));
+    memcpy(data, data_.data() + position, size);
+    return static_cast<ssize_t>(size);
+}
+
+parallel_parser::parallel_parser(int fd, size_t threads) : threads_(std::max<size_t>(threads, 1)) {
+    struct stat info;
+    off_t start = lseek(fd, 0, SEEK_CUR);
+    if (start != -1 && fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > start) {
+        void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, info.st_size, MADV_WILLNEED);
+            mapped_size_ = info.st_size;
+            mapped_offset_ = start;
+            data_ = static_cast<const char*>(mapping) + start;
+            size_ = mapped_size_ - mapped_offset_;
+            lseek(fd, 0, SEEK_END);
+            return;
+        }
+    }
+    char buffer[1 << 16];
+    while (true) {
+        ssize_t read_size = read(fd, buffer, sizeof(buffer));
+        if (read_size == -1 && errno == EINTR) {
+            continue;
+        }
+        if (read_size <= 0) {
+            error_ = read_size == -1;
+            break;
+        }
+        storage_.append(buffer, read_size);
+    }
+    data_ = storage_.data();
+    size_ = storage_.size();
+}
+
+parallel_parser::~parallel_parser() {
+    if (mapped_size_ != 0) {
+        munmap(const_cast<char*>(data_ - mapped_offset_), mapped_size_);
+    }
+}
+
+size_t parallel_parser::threads() const {
+    return threads_;
+}
+
+bool parallel_parser::fail() const {
+    return error_;
+}
+
+std::vector<std::string_view> parallel_parser::split(size_t count) const {
+    count = std::clamp<size_t>(size_ / kMinChunkSize, 1, count);
+    std::vector<std::string_view> chunks;
+    size_t begin = 0;
+    for (size_t i = 1; i <= count; ++i) {
+        size_t end = std::max(begin, size_ / count * i);
+        if (i == count) {
+            end = size_;
+        }
+        end = utils::find_space(data_ + end, data_ + size_) - data_;
+        chunks.emplace_back(data_ + begin, end - begin);
+        begin = end;
+    }
+    return chunks;
+}
+
+void parallel_parser::run(size_t count, const std::function<void(size_t)>& task) const {
+    std::atomic<size_t> next = 0;
+    auto work = [&] {
+        for (size_t index = next++; index < count; index = next++) {
+            task(index);
+        }
+    };
+    std::vector<std::jthread> workers;
+    for (size_t i = 1; i < std::min(threads_, count); ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+}
+}  // namespace stdlike
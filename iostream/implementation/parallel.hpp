@@ -0,0 +1,116 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "iostream.hpp"
+
+namespace stdlike {
+
+// Input stream over bytes already in memory. Without a buffer size the bytes are parsed in
+// place; with one they are copied through a buffer of that size, as if read from a descriptor.
+class memory_istream : public istream {
+public:
+    explicit memory_istream(std::string_view data);
+
+    memory_istream(std::string_view data, size_t buffer_size);
+
+protected:
+    ssize_t read_buffer(char* data, size_t size, long long position) override;
+
+private:
+    std::string_view data_;
+};
+
+namespace detail {
+struct parallel_access {
+    template <class T>
+    static bool parse(istream& in, T& value) {
+        return in.parse_buffered(value) || !(in >> value).fail();
+    }
+
+    static size_t position(const istream& in) {
+        return static_cast<size_t>(in.absolute_offset_ + in.offset_);
+    }
+};
+}  // namespace detail
+
+// Parses a whole file of whitespace-separated values on several threads. The rest of the file
+// from the current position of fd is mapped (or read into memory when it cannot be), cut at
+// token boundaries into chunks, and each chunk is parsed with the istream parsers. Results keep
+// the file order.
+class parallel_parser {
+public:
+    static constexpr size_t kMinChunkSize = 1 << 20;
+
+    explicit parallel_parser(int fd, size_t threads = std::thread::hardware_concurrency());
+
+    parallel_parser(const parallel_parser&) = delete;
+    parallel_parser& operator=(const parallel_parser&) = delete;
+
+    ~parallel_parser();
+
+    // Every value up to the end of the input; stops at the first malformed token and sets fail().
+    template <class T>
+    std::vector<T> parse();
+
+    size_t threads() const;
+
+    bool fail() const;
+
+private:
+    // Splits the input into at most count chunks, each ending right before a space.
+    std::vector<std::string_view> split(size_t count) const;
+
+    // Runs task(i) for every i < count on up to threads_ threads.
+    void run(size_t count, const std::function<void(size_t)>& task) const;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t mapped_size_ = 0;
+    size_t mapped_offset_ = 0;
+    std::string storage_;
+    size_t threads_;
+    bool error_{false};
+};
+
+template <class T>
+std::vector<T> parallel_parser::parse() {
+    std::vector<std::string_view> chunks = split(threads_ * 4);
+    std::vector<std::vector<T>> parts(chunks.size());
+    std::vector<char> failed(chunks.size(), false);
+    run(chunks.size(), [&](size_t index) {
+        std::string_view chunk = chunks[index];
+        memory_istream in(chunk);
+        std::vector<T>& values = parts[index];
+        values.reserve(chunk.size() / 8);
+        while (true) {
+            size_t position = detail::parallel_access::position(in);
+            T value;
+            if (!detail::parallel_access::parse(in, value)) {
+                failed[index] = !std::all_of(chunk.begin() + position, chunk.end(), utils::isspace);
+                return;
+            }
+            values.push_back(value);
+        }
+    });
+
+    size_t count = std::find(failed.begin(), failed.end(), true) - failed.begin();
+    bool malformed = count != failed.size();
+    error_ |= malformed;
+    count += malformed;
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += parts[i].size();
+    }
+    std::vector<T> values;
+    values.reserve(total);
+    for (size_t i = 0; i < count; ++i) {
+        values.insert(values.end(), parts[i].begin(), parts[i].end());
+    }
+    return values;
+}
+}  // namespace stdlike
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <concepts>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "iostream.hpp"
+
+namespace stdlike {
+
+namespace detail {
+enum class arg_kind { integer, boolean, character, floating, string, pointer };
+
+template <class T>
+consteval arg_kind kind_of() {
+    if constexpr (std::is_same_v<T, bool>) {
+        return arg_kind::boolean;
+    } else if constexpr (std::is_same_v<T, char>) {
+        return arg_kind::character;
+    } else if constexpr (std::is_integral_v<T>) {
+        static_assert(sizeof(T) <= sizeof(uint64_t), "print supports integers up to 64 bits");
+        return arg_kind::integer;
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return arg_kind::floating;
+    } else if constexpr (std::is_null_pointer_v<T>) {
+        return arg_kind::pointer;
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        return arg_kind::string;
+    } else if constexpr (std::is_pointer_v<T>) {
+        return arg_kind::pointer;
+    } else {
+        static_assert(!sizeof(T), "type is not printable");
+    }
+}
+
+// Literal text before a replacement field; escaped when it contains "{{" or "}}".
+struct literal {
+    uint32_t begin = 0;
+    uint16_t size = 0;
+    uint16_t output_size = 0;
+};
+
+struct field_spec {
+    char type = '\0';
+    int16_t precision = -1;
+};
+
+// Not constexpr on purpose: reaching it during constant evaluation reports the message.
+void format_error(const char* message);
+}  // namespace detail
+
+// Format string checked against the argument types at compile time. Supports "{}" for every
+// argument, "{:f}", "{:e}", "{:g}" with an optional ".precision" for floating values, and the
+// "{{" / "}}" escapes.
+template <class... Args>
+class basic_format_string {
+public:
+    template <class S>
+        requires std::convertible_to<const S&, std::string_view>
+    consteval basic_format_string(const S& format) : format_(format) {
+        if (format_.size() > std::numeric_limits<uint16_t>::max()) {
+            detail::format_error("format string is too long");
+        }
+        constexpr std::array<detail::arg_kind, sizeof...(Args)> kinds{
+            detail::kind_of<std::remove_cvref_t<std::decay_t<Args>>>()...};
+        size_t field = 0;
+        size_t position = 0;
+        while (true) {
+            detail::literal& text = literals_[field];
+            text.begin = position;
+            while (position < format_.size()) {
+                char symbol = format_[position];
+                if (symbol == '}') {
+                    if (position + 1 == format_.size() || format_[position + 1] != '}') {
+                        detail::format_error("unmatched '}' in format string");
+                    }
+                    ++position;
+                } else if (symbol == '{') {
+                    if (position + 1 == format_.size() || format_[position + 1] != '{') {
+                        break;
+                    }
+                    ++position;
+                }
+                ++position;
+                ++text.output_size;
+            }
+            text.size = position - text.begin;
+            if (position == format_.size()) {
+                break;
+            }
+            if (field == sizeof...(Args)) {
+                detail::format_error("more replacement fields than arguments");
+            }
+            position = parse_spec(position + 1, specs_[field], kinds[field]);
+            ++field;
+        }
+        if (field != sizeof...(Args)) {
+            detail::format_error("fewer replacement fields than arguments");
+        }
+    }
+
+    std::string_view get() const {
+        return format_;
+    }
+
+    const detail::literal& text(size_t index) const {
+        return literals_[index];
+    }
+
+    const detail::field_spec& spec(size_t index) const {
+        return specs_[index];
+    }
+
+private:
+    consteval size_t parse_spec(size_t position, detail::field_spec& spec, detail::arg_kind kind) {
+        if (position < format_.size() && format_[position] == ':') {
+            ++position;
+            if (position < format_.size() && format_[position] == '.') {
+                ++position;
+                if (position == format_.size() || !utils::isdigit(format_[position])) {
+                    detail::format_error("missing precision after '.'");
+                }
+                spec.precision = 0;
+                while (position < format_.size() && utils::isdigit(format_[position])) {
+                    spec.precision = spec.precision * 10 + utils::digit_value(format_[position++]);
+                    if (spec.precision > 1000) {
+                        detail::format_error("precision is too large");
+                    }
+                }
+            }
+            if (position < format_.size() && format_[position] != '}') {
+                spec.type = format_[position++];
+                if (spec.type != 'f' && spec.type != 'e' && spec.type != 'g') {
+                    detail::format_error("unknown presentation type");
+                }
+            }
+            if (kind != detail::arg_kind::floating) {
+                detail::format_error("format spec is only supported for floating arguments");
+            }
+        }
+        if (position == format_.size() || format_[position] != '}') {
+            detail::format_error("expected '}' in replacement field");
+        }
+        return position + 1;
+    }
+
+    std::string_view format_;
+    std::array<detail::literal, sizeof...(Args) + 1> literals_{};
+    std::array<detail::field_spec, sizeof...(Args)> specs_{};
+};
+
+template <class... Args>
+using format_string = basic_format_string<std::type_identity_t<Args>...>;
+
+namespace detail {
+template <class T>
+auto normalize(const T& value) {
+    if constexpr (kind_of<T>() == arg_kind::string) {
+        return std::string_view(value);
+    } else if constexpr (kind_of<T>() == arg_kind::pointer) {
+        return static_cast<const void*>(value);
+    } else {
+        return value;
+    }
+}
+
+template <class T>
+auto magnitude_of(T value) {
+    using Unsigned = std::make_unsigned_t<T>;
+    auto magnitude = static_cast<Unsigned>(value);
+    if constexpr (std::is_signed_v<T>) {
+        if (value < 0) {
+            magnitude = static_cast<Unsigned>(Unsigned(0) - magnitude);
+        }
+    }
+    return magnitude;
+}
+
+inline size_t hex_digits(const void* value) {
+    return std::max<size_t>(1, (std::bit_width(reinterpret_cast<uintptr_t>(value)) + 3) / 4);
+}
+
+// Upper bound of the formatted size; exact for everything except floating values.
+template <arg_kind Kind, class T>
+size_t field_size(const T& value, const field_spec& spec) {
+    if constexpr (Kind == arg_kind::integer) {
+        size_t size = utils::count_digits(magnitude_of(value));
+        if constexpr (std::is_signed_v<T>) {
+            size += value < 0;
+        }
+        return size;
+    } else if constexpr (Kind == arg_kind::boolean) {
+        return value ? 4 : 5;
+    } else if constexpr (Kind == arg_kind::character) {
+        return 1;
+    } else if constexpr (Kind == arg_kind::floating) {
+        size_t precision = spec.precision < 0 ? 17 : spec.precision;
+        if (spec.type == 'f') {
+            return std::numeric_limits<T>::max_exponent10 + precision + 3;
+        }
+        return precision + 16;
+    } else if constexpr (Kind == arg_kind::string) {
+        return value.size();
+    } else {
+        return 2 + hex_digits(value);
+    }
+}
+
+// Writes value into out, where size is what field_size() returned for it.
+template <arg_kind Kind, class T>
+char* write_field(char* out, const T& value, const field_spec& spec, size_t size) {
+    if constexpr (Kind == arg_kind::integer) {
+        out[0] = '-';
+        utils::format_digits(magnitude_of(value), out + size);
+        return out + size;
+    } else if constexpr (Kind == arg_kind::boolean) {
+        std::string_view text = value ? "true" : "false";
+        return std::copy(text.begin(), text.end(), out);
+    } else if constexpr (Kind == arg_kind::character) {
+        *out = value;
+        return out + 1;
+    } else if constexpr (Kind == arg_kind::floating) {
+        char* last = out + size;
+        if (spec.type == '\0' && spec.precision < 0) {
+            return std::to_chars(out, last, value).ptr;
+        }
+        auto format = spec.type == 'f'   ? std::chars_format::fixed
+                      : spec.type == 'e' ? std::chars_format::scientific
+                                         : std::chars_format::general;
+        return std::to_chars(out, last, value, format, spec.precision < 0 ? 6 : spec.precision)
+            .ptr;
+    } else if constexpr (Kind == arg_kind::string) {
+        memcpy(out, value.data(), value.size());
+        return out + value.size();
+    } else {
+        out[0] = '0';
+        out[1] = 'x';
+        auto address = reinterpret_cast<uintptr_t>(value);
+        for (size_t i = size; i > 2; --i, address >>= 4) {
+            out[i - 1] = "0123456789abcdef"[address & 15];
+        }
+        return out + size;
+    }
+}
+
+// Literals are usually a few bytes, so fixed-size overlapping copies beat a memcpy call.
+inline void copy_short(char* out, const char* first, size_t size) {
+    if (size >= 8 && size <= 16) {
+        memcpy(out, first, 8);
+        memcpy(out + size - 8, first + size - 8, 8);
+    } else if (size >= 4 && size < 8) {
+        memcpy(out, first, 4);
+        memcpy(out + size - 4, first + size - 4, 4);
+    } else if (size > 16) {
+        memcpy(out, first, size);
+    } else {
+        for (size_t i = 0; i < size; ++i) {
+            out[i] = first[i];
+        }
+    }
+}
+
+inline char* write_literal(char* out, std::string_view format, const literal& text) {
+    const char* first = format.data() + text.begin;
+    if (text.size == text.output_size) {
+        copy_short(out, first, text.size);
+        return out + text.size;
+    }
+    for (const char* last = first + text.size; first != last; ++first) {
+        *out++ = *first;
+        first += *first == '{' || *first == '}';
+    }
+    return out;
+}
+
+struct print_access {
+    template <class Format, class... Args, size_t... I>
+    static ostream& print(ostream& out, const Format& format, std::index_sequence<I...> indices,
+                          const Args&... args) {
+        std::array<size_t, sizeof...(Args)> sizes{
+            field_size<kind_of<std::decay_t<Args>>()>(args, format.spec(I))...};
+        size_t size = format.text(sizeof...(Args)).output_size;
+        ((size += format.text(I).output_size + sizes[I]), ...);
+        if (char* target = out.reserve(size); target != nullptr) {
+            out.offset_ = write(target, format, sizes, indices, args...) - out.buffer_.get();
+        } else {
+            std::string buffer(size, '\0');
+            char* end = write(buffer.data(), format, sizes, indices, args...);
+            out.write(buffer.data(), end - buffer.data());
+        }
+        return out;
+    }
+
+    // Inlined into both paths so the format object never escapes and its fields fold into
+    // constants.
+    template <class Format, class... Args, size_t... I>
+    [[gnu::always_inline]] static char* write(char* target, const Format& format,
+                                              const std::array<size_t, sizeof...(Args)>& sizes,
+                                              std::index_sequence<I...>, const Args&... args) {
+        ((target = write_literal(target, format.get(), format.text(I)),
+          target = write_field<kind_of<std::decay_t<Args>>()>(target, args, format.spec(I),
+                                                              sizes[I])),
+         ...);
+        return write_literal(target, format.get(), format.text(sizeof...(Args)));
+    }
+};
+}  // namespace detail
+
+// Formats args into out, reserving the whole output span once.
+template <class... Args>
+ostream& print(ostream& out, format_string<Args...> format, const Args&... args) {
+    return detail::print_access::print(out, format, std::index_sequence_for<Args...>{},
+                                       detail::normalize(args)...);
+}
+}  // namespace stdlike
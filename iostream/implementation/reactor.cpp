@@ -0,0 +1,239 @@
+#include "reactor.hpp"
+
+#include <cerrno>
+#include <utility>
+
+namespace stdlike {
+
+nonblocking_istream::nonblocking_istream(int fd, size_t buffer_size) : istream(fd, buffer_size) {
+    tie(nullptr);
+    error_ = !set_nonblocking(true);
+}
+
+nonblocking_ostream::nonblocking_ostream(int fd, size_t buffer_size, size_t max_backlog)
+    : ostream(fd, buffer_size), max_backlog_(max_backlog) {
+    bypass_ = false;
+    int flags = fcntl(fd, F_GETFL);
+    error_ = flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1;
+}
+
+nonblocking_ostream::~nonblocking_ostream() {
+    flush();
+    offset_ = 0;
+}
+
+ostream& nonblocking_ostream::flush() {
+    error_ = would_block_;
+    write_buffer();
+    return *this;
+}
+
+size_t nonblocking_ostream::pending() const {
+    return backlog_.size() - sent_ + offset_;
+}
+
+bool nonblocking_ostream::would_block() const {
+    return would_block_;
+}
+
+void nonblocking_ostream::clear() {
+    error_ = would_block_ = false;
+}
+
+void nonblocking_ostream::write_buffer() {
+    size_t buffered = offset_;
+    offset_ = 0;
+    iovec parts[2] = {{backlog_.data() + sent_, backlog_.size() - sent_},
+                      {buffer_.get(), buffered}};
+    size_t total = parts[0].iov_len + buffered;
+    size_t written = 0;
+    while (written < total) {
+        ssize_t size = writev(fd_, parts, 2);
+        if (size == -1 && errno == EINTR) {
+            continue;
+        }
+        if (size == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                error_ = true;
+                backlog_.clear();
+                sent_ = 0;
+                return;
+            }
+            break;
+        }
+        written += size;
+        for (iovec& part : parts) {
+            size_t taken = std::min<size_t>(size, part.iov_len);
+            part.iov_base = static_cast<char*>(part.iov_base) + taken;
+            part.iov_len -= taken;
+            size -= static_cast<ssize_t>(taken);
+        }
+    }
+
+    sent_ = backlog_.size() - parts[0].iov_len;
+    if (sent_ == backlog_.size()) {
+        backlog_.clear();
+        sent_ = 0;
+    } else if (sent_ > backlog_.size() / 2) {
+        backlog_.erase(0, sent_);
+        sent_ = 0;
+    }
+    if (backlog_.size() - sent_ + parts[1].iov_len > max_backlog_) {
+        error_ = would_block_ = true;
+        return;
+    }
+    backlog_.append(static_cast<const char*>(parts[1].iov_base), parts[1].iov_len);
+}
+
+reactor::reactor() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)) {
+}
+
+reactor::~reactor() {
+    if (epoll_fd_ != -1) {
+        close(epoll_fd_);
+    }
+}
+
+bool reactor::valid() const {
+    return epoll_fd_ != -1;
+}
+
+bool reactor::add(int fd, handler on_ready, uint32_t events) {
+    entry& watched = find_or_add(fd);
+    watched.on_ready = std::move(on_ready);
+    watched.interest = events;
+    return update(fd, watched);
+}
+
+bool reactor::remove(int fd) {
+    auto it = entries_.find(fd);
+    if (it == entries_.end()) {
+        return false;
+    }
+    if (it->second->events != 0) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    retired_.push_back(std::move(it->second));
+    entries_.erase(it);
+    return true;
+}
+
+bool reactor::flush(nonblocking_ostream& out) {
+    out.flush();
+    auto it = entries_.find(out.fd());
+    if (out.pending() == 0) {
+        if (it != entries_.end() && it->second->out == &out) {
+            it->second->out = nullptr;
+            return update(out.fd(), *it->second);
+        }
+        return !out.fail();
+    }
+    entry& watched = find_or_add(out.fd());
+    watched.out = &out;
+    return update(out.fd(), watched);
+}
+
+bool reactor::wait(int fd, uint32_t events, std::function<void()> callback) {
+    entry& watched = find_or_add(fd);
+    ((events & EPOLLOUT) != 0 ? watched.writable : watched.readable) = std::move(callback);
+    if (!update(fd, watched)) {
+        ((events & EPOLLOUT) != 0 ? watched.writable : watched.readable) = nullptr;
+        update(fd, watched);
+        return false;
+    }
+    return true;
+}
+
+reactor::entry& reactor::find_or_add(int fd) {
+    auto [it, inserted] = entries_.try_emplace(fd);
+    if (inserted) {
+        it->second = std::make_unique<entry>();
+    }
+    return *it->second;
+}
+
+bool reactor::update(int fd, entry& watched) {
+    uint32_t events = watched.interest;
+    if (watched.readable) {
+        events |= EPOLLIN;
+    }
+    if (watched.writable || watched.out != nullptr) {
+        events |= EPOLLOUT;
+    }
+    if (events != watched.events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = fd;
+        int operation = watched.events == 0 ? EPOLL_CTL_ADD
+                        : events == 0       ? EPOLL_CTL_DEL
+                                            : EPOLL_CTL_MOD;
+        if (epoll_ctl(epoll_fd_, operation, fd, &event) == -1) {
+            return false;
+        }
+        watched.events = events;
+    }
+    if (events == 0 && !watched.on_ready) {
+        remove(fd);
+    }
+    return true;
+}
+
+int reactor::run_once(int timeout_ms) {
+    constexpr int kMaxEvents = 64;
+    constexpr uint32_t kClosed = EPOLLERR | EPOLLHUP;
+    epoll_event events[kMaxEvents];
+    int count = epoll_wait(epoll_fd_, events, kMaxEvents, timeout_ms);
+    if (count == -1) {
+        return errno == EINTR ? 0 : -1;
+    }
+    for (int i = 0; i < count; ++i) {
+        int fd = events[i].data.fd;
+        uint32_t ready = events[i].events;
+        auto it = entries_.find(fd);
+        if (it == entries_.end()) {
+            continue;
+        }
+        entry* watched = it->second.get();
+        // Callbacks may remove fd or replace its entry; the rest of the event then goes stale.
+        auto current = [&] {
+            auto found = entries_.find(fd);
+            return found != entries_.end() && found->second.get() == watched;
+        };
+        if ((ready & (EPOLLOUT | kClosed)) != 0 && watched->out != nullptr) {
+            flush(*watched->out);
+        }
+        if ((ready & (EPOLLOUT | kClosed)) != 0 && watched->writable && current()) {
+            auto callback = std::exchange(watched->writable, nullptr);
+            update(fd, *watched);
+            callback();
+        }
+        if ((ready & (EPOLLIN | EPOLLRDHUP | kClosed)) != 0 && watched->readable && current()) {
+            auto callback = std::exchange(watched->readable, nullptr);
+            update(fd, *watched);
+            callback();
+        }
+        if (watched->on_ready && (ready & (watched->interest | kClosed)) != 0 && current()) {
+            watched->on_ready(ready);
+        }
+    }
+    retired_.clear();
+    return count;
+}
+
+void reactor::run() {
+    stopped_ = false;
+    while (!stopped_ && !entries_.empty()) {
+        if (run_once() == -1) {
+            return;
+        }
+    }
+}
+
+void reactor::stop() {
+    stopped_ = true;
+}
+
+size_t reactor::size() const {
+    return entries_.size();
+}
+}  // namespace stdlike
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <sys/epoll.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "iostream.hpp"
+
+namespace stdlike {
+
+// Input stream over a non-blocking descriptor. Reads that find no data fail with would_block()
+// and keep the partial token buffered; call clear() and read again once the descriptor is
+// readable.
+class nonblocking_istream : public istream {
+public:
+    explicit nonblocking_istream(int fd, size_t buffer_size = kDefaultBufferSize);
+};
+
+// Output stream that never waits for its descriptor: whatever the descriptor does not take is
+// queued, and each flush() sends as much of the queue as it can. Queued data that was never sent
+// is dropped on destruction.
+//
+// At most max_backlog bytes are queued. Output that does not fit is dropped and sets fail() and
+// would_block() until clear(); keep pending() low, e.g. by waiting in reactor::flush(), to avoid
+// that.
+class nonblocking_ostream : public ostream {
+public:
+    static constexpr size_t kDefaultBacklog = 1 << 22;
+
+    explicit nonblocking_ostream(int fd, size_t buffer_size = kDefaultBufferSize,
+                                 size_t max_backlog = kDefaultBacklog);
+
+    ~nonblocking_ostream();
+
+    ostream& flush() override;
+
+    // Bytes written to the stream but not to the descriptor yet.
+    size_t pending() const;
+
+    // Whether output was dropped because the queue was full.
+    bool would_block() const;
+
+    void clear();
+
+protected:
+    void write_buffer() override;
+
+private:
+    std::string backlog_;
+    size_t sent_ = 0;
+    size_t max_backlog_;
+    bool would_block_{false};
+};
+
+// Level-triggered epoll loop driving many descriptors from one thread.
+class reactor {
+public:
+    using handler = std::function<void(uint32_t events)>;
+
+    reactor();
+
+    reactor(const reactor&) = delete;
+    reactor& operator=(const reactor&) = delete;
+
+    ~reactor();
+
+    bool valid() const;
+
+    // Calls on_ready with the ready events (EPOLLHUP and EPOLLERR included) whenever fd is ready
+    // for events. Handlers may add and remove descriptors, themselves included.
+    bool add(int fd, handler on_ready, uint32_t events = EPOLLIN);
+
+    bool remove(int fd);
+
+    // Flushes out and, while data stays queued, flushes it again whenever its descriptor becomes
+    // writable. Returns false if the descriptor cannot be watched.
+    bool flush(nonblocking_ostream& out);
+
+    // Calls callback once, the next time fd is ready for events (EPOLLIN or EPOLLOUT). One
+    // callback per direction may wait on a descriptor, alongside its add() handler. Returns false
+    // if the descriptor cannot be watched, as for regular files.
+    bool wait(int fd, uint32_t events, std::function<void()> callback);
+
+    // Waits up to timeout_ms for ready descriptors and runs their handlers. Returns the number of
+    // ready descriptors, or -1 on error.
+    int run_once(int timeout_ms = -1);
+
+    // Runs until stop() or until no descriptor is registered.
+    void run();
+
+    void stop();
+
+    size_t size() const;
+
+private:
+    struct entry {
+        handler on_ready;
+        uint32_t interest = 0;
+        std::function<void()> readable;
+        std::function<void()> writable;
+        nonblocking_ostream* out = nullptr;
+        // Events registered with epoll.
+        uint32_t events = 0;
+    };
+
+    entry& find_or_add(int fd);
+
+    // Registers the events entry needs, dropping it once it needs nothing.
+    bool update(int fd, entry& watched);
+
+    int epoll_fd_;
+    std::unordered_map<int, std::unique_ptr<entry>> entries_;
+    // Entries removed during run_once(), kept alive until their handlers return.
+    std::vector<std::unique_ptr<entry>> retired_;
+    bool stopped_{false};
+};
+}  // namespace stdlike
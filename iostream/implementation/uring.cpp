@@ -0,0 +1,372 @@
+#include "uring.hpp"
+
+#include <sys/syscall.h>
+
+#include <atomic>
+#include <cerrno>
+
+namespace stdlike {
+
+namespace {
+unsigned load_acquire(unsigned* value) {
+    return std::atomic_ref<unsigned>(*value).load(std::memory_order_acquire);
+}
+
+void store_release(unsigned* value, unsigned desired) {
+    std::atomic_ref<unsigned>(*value).store(desired, std::memory_order_release);
+}
+
+template <class T>
+T* at(void* base, unsigned offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+bool is_retryable(int error, int fd) {
+    return error == EINTR || error == EAGAIN || (error == EINVAL && utils::drop_direct(fd));
+}
+
+// Reads at a given offset only work on seekable descriptors without O_APPEND.
+bool is_positional(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    return flags != -1 && (flags & O_APPEND) == 0 && lseek(fd, 0, SEEK_CUR) != -1;
+}
+}  // namespace
+
+utils::io_ring::io_ring(unsigned entries) {
+    io_uring_params params{};
+    fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd_ == -1) {
+        return;
+    }
+    // Plain reads and writes (IORING_OP_READ/WRITE) arrived together with this feature.
+    if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) {
+        release();
+        return;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    fd_, IORING_OFF_SQ_RING);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+        cq_ring_ = sq_ring_;
+    } else if (sq_ring_ != MAP_FAILED) {
+        cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    if (cq_ring_ != MAP_FAILED) {
+        sqes_ = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                                                MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+    }
+    if (sqes_ == MAP_FAILED) {
+        release();
+        return;
+    }
+    sq_head_ = at<unsigned>(sq_ring_, params.sq_off.head);
+    sq_tail_ = at<unsigned>(sq_ring_, params.sq_off.tail);
+    sq_array_ = at<unsigned>(sq_ring_, params.sq_off.array);
+    sq_mask_ = *at<unsigned>(sq_ring_, params.sq_off.ring_mask);
+    cq_head_ = at<unsigned>(cq_ring_, params.cq_off.head);
+    cq_tail_ = at<unsigned>(cq_ring_, params.cq_off.tail);
+    cqes_ = at<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+    cq_mask_ = *at<unsigned>(cq_ring_, params.cq_off.ring_mask);
+}
+
+utils::io_ring::~io_ring() {
+    release();
+}
+
+void utils::io_ring::release() {
+    if (sqes_ != MAP_FAILED) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+    if (fd_ != -1) {
+        close(fd_);
+    }
+    sq_ring_ = cq_ring_ = MAP_FAILED;
+    sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+    fd_ = -1;
+}
+
+bool utils::io_ring::valid() const {
+    return fd_ != -1;
+}
+
+void utils::io_ring::prepare(uint8_t opcode, int fd, void* data, size_t size, uint64_t offset,
+                             uint64_t user_data) {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & sq_mask_;
+    io_uring_sqe& sqe = sqes_[index];
+    sqe = io_uring_sqe{};
+    sqe.opcode = opcode;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(data);
+    sqe.len = static_cast<uint32_t>(std::min<size_t>(size, std::numeric_limits<int32_t>::max()));
+    sqe.off = offset;
+    sqe.user_data = user_data;
+    sq_array_[index] = index;
+    store_release(sq_tail_, tail + 1);
+    ++queued_;
+}
+
+bool utils::io_ring::submit(unsigned wait) {
+    while (queued_ > 0 || wait > 0) {
+        long submitted = syscall(__NR_io_uring_enter, fd_, queued_, wait,
+                                 wait > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (submitted == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        queued_ -= static_cast<unsigned>(submitted);
+        wait = 0;
+    }
+    return true;
+}
+
+bool utils::io_ring::complete(io_uring_cqe& cqe, bool block) {
+    while (true) {
+        unsigned head = *cq_head_;
+        if (head != load_acquire(cq_tail_)) {
+            cqe = cqes_[head & cq_mask_];
+            store_release(cq_head_, head + 1);
+            return true;
+        }
+        if (!block || !submit(1)) {
+            return false;
+        }
+    }
+}
+
+uring_istream::uring_istream(int fd, size_t buffer_size, size_t depth)
+    : istream(fd, buffer_size),
+      ring_(static_cast<unsigned>(std::max<size_t>(depth, 1))),
+      positional_(is_positional(fd)) {
+    depth_ = positional_ ? std::max<size_t>(depth, 1) : 1;
+}
+
+uring_istream::~uring_istream() {
+    for (chunk& request : chunks_) {
+        wait(request);
+    }
+}
+
+bool uring_istream::uses_uring() const {
+    return ring_.valid();
+}
+
+ssize_t uring_istream::read_buffer(char* data, size_t size, long long position) {
+    if (!ring_.valid()) {
+        return istream::read_buffer(data, size, position);
+    }
+    if (chunks_.empty() ||
+        (positional_ &&
+         chunks_.front().position + static_cast<long long>(chunks_.front().consumed) != position)) {
+        restart(position);
+    }
+    chunk& front = chunks_.front();
+    wait(front);
+    if (front.size <= 0) {
+        ssize_t result = front.size;
+        for (chunk& request : chunks_) {
+            wait(request);
+        }
+        chunks_.clear();
+        if (result < 0) {
+            errno = static_cast<int>(-result);
+            return -1;
+        }
+        return 0;
+    }
+    size_t available = static_cast<size_t>(front.size) - front.consumed;
+    if (data == buffer_ && size == capacity_ && front.consumed == 0 &&
+        front.capacity == capacity_) {
+        std::swap(storage_, front.data);
+        buffer_ = storage_.get();
+        recycle();
+        return static_cast<ssize_t>(available);
+    }
+    size_t length = std::min(size, available);
+    memcpy(data, front.data.get() + front.consumed, length);
+    front.consumed += length;
+    if (front.consumed == static_cast<size_t>(front.size)) {
+        recycle();
+    }
+    return static_cast<ssize_t>(length);
+}
+
+void uring_istream::submit(chunk& request) {
+    request.size = 0;
+    request.consumed = 0;
+    request.done = false;
+    uint64_t offset = positional_ ? static_cast<uint64_t>(request.position) : ~uint64_t{0};
+    ring_.prepare(IORING_OP_READ, fd_, request.data.get(), request.capacity, offset,
+                  reinterpret_cast<uint64_t>(&request));
+}
+
+void uring_istream::wait(chunk& request) {
+    io_uring_cqe cqe;
+    while (!request.done && ring_.complete(cqe, true)) {
+        auto* completed = reinterpret_cast<chunk*>(cqe.user_data);
+        if (cqe.res < 0 && is_retryable(-cqe.res, fd_)) {
+            submit(*completed);
+            ring_.submit();
+            continue;
+        }
+        completed->size = cqe.res;
+        completed->done = true;
+    }
+    if (!request.done) {
+        request.size = -errno;
+        request.done = true;
+    }
+}
+
+void uring_istream::restart(long long position) {
+    for (chunk& request : chunks_) {
+        wait(request);
+    }
+    chunks_.resize(depth_);
+    next_position_ = position;
+    for (chunk& request : chunks_) {
+        if (!request.data || request.capacity != capacity_) {
+            request.data = utils::allocate_buffer(capacity_);
+            request.capacity = capacity_;
+        }
+        request.position = next_position_;
+        next_position_ += static_cast<long long>(request.capacity);
+        submit(request);
+    }
+    ring_.submit();
+}
+
+void uring_istream::recycle() {
+    chunk request = std::move(chunks_.front());
+    chunks_.pop_front();
+    if (request.capacity != capacity_) {
+        request.data = utils::allocate_buffer(capacity_);
+        request.capacity = capacity_;
+    }
+    request.position = next_position_;
+    next_position_ += static_cast<long long>(request.capacity);
+    chunks_.push_back(std::move(request));
+    submit(chunks_.back());
+    ring_.submit();
+}
+
+uring_ostream::uring_ostream(int fd, size_t buffer_size, size_t depth)
+    : ostream(fd, buffer_size),
+      ring_(static_cast<unsigned>(std::max<size_t>(depth, 1))),
+      positional_(is_positional(fd)) {
+    depth_ = positional_ ? std::max<size_t>(depth, 1) : 1;
+    if (positional_) {
+        position_ = lseek(fd, 0, SEEK_CUR);
+    }
+    if (ring_.valid()) {
+        bypass_ = false;
+    }
+}
+
+uring_ostream::~uring_ostream() {
+    flush();
+}
+
+ostream& uring_ostream::flush() {
+    if (!ring_.valid()) {
+        return ostream::flush();
+    }
+    error_ = false;
+    write_buffer();
+    while (!chunks_.empty()) {
+        complete(true);
+    }
+    if (positional_) {
+        lseek(fd_, position_, SEEK_SET);
+    }
+    return *this;
+}
+
+bool uring_ostream::uses_uring() const {
+    return ring_.valid();
+}
+
+void uring_ostream::write_buffer() {
+    if (!ring_.valid()) {
+        ostream::write_buffer();
+        return;
+    }
+    if (offset_ == 0) {
+        return;
+    }
+    complete(false);
+    while (chunks_.size() >= depth_) {
+        complete(true);
+    }
+    chunks_.push_back({std::move(buffer_), capacity_, position_, offset_, 0, false});
+    position_ += static_cast<long long>(offset_);
+    submit(chunks_.back());
+    ring_.submit();
+    while (!spare_.empty() && !buffer_) {
+        if (spare_.back().capacity == capacity_) {
+            buffer_ = std::move(spare_.back().data);
+        }
+        spare_.pop_back();
+    }
+    if (!buffer_) {
+        buffer_ = utils::allocate_buffer(capacity_);
+    }
+    offset_ = 0;
+}
+
+void uring_ostream::submit(chunk& request) {
+    uint64_t offset = positional_ ? static_cast<uint64_t>(request.position) + request.written
+                                  : ~uint64_t{0};
+    ring_.prepare(IORING_OP_WRITE, fd_, request.data.get() + request.written,
+                  request.size - request.written, offset, reinterpret_cast<uint64_t>(&request));
+}
+
+void uring_ostream::complete(bool block) {
+    io_uring_cqe cqe;
+    while (ring_.complete(cqe, block)) {
+        auto* completed = reinterpret_cast<chunk*>(cqe.user_data);
+        if (cqe.res < 0 && is_retryable(-cqe.res, fd_)) {
+            submit(*completed);
+        } else if (cqe.res < 0) {
+            error_ = true;
+            completed->done = true;
+        } else {
+            completed->written += static_cast<size_t>(cqe.res);
+            completed->done = completed->written == completed->size;
+            if (!completed->done) {
+                submit(*completed);
+            }
+        }
+        ring_.submit();
+        block = false;
+    }
+    if (block) {
+        error_ = true;
+        for (chunk& request : chunks_) {
+            request.done = true;
+        }
+    }
+    retire();
+}
+
+void uring_ostream::retire() {
+    while (!chunks_.empty() && chunks_.front().done) {
+        spare_.push_back(std::move(chunks_.front()));
+        chunks_.pop_front();
+    }
+}
+}  // namespace stdlike
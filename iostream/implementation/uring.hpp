@@ -0,0 +1,140 @@
+#pragma once
+
+#include <linux/io_uring.h>
+
+#include <deque>
+#include <vector>
+
+#include "iostream.hpp"
+
+namespace stdlike {
+
+namespace utils {
+// Minimal io_uring wrapper over the raw syscalls. invalid() rings (old kernels, seccomp) make
+// the streams below fall back to plain read/write.
+class io_ring {
+public:
+    explicit io_ring(unsigned entries);
+
+    io_ring(const io_ring&) = delete;
+    io_ring& operator=(const io_ring&) = delete;
+
+    ~io_ring();
+
+    bool valid() const;
+
+    // Queues a read or write; offset -1 uses and advances the file position.
+    void prepare(uint8_t opcode, int fd, void* data, size_t size, uint64_t offset,
+                 uint64_t user_data);
+
+    // Submits queued entries and waits for at least wait completions.
+    bool submit(unsigned wait = 0);
+
+    // Pops one completion, blocking for it when block is set.
+    bool complete(io_uring_cqe& cqe, bool block);
+
+private:
+    void release();
+
+    int fd_ = -1;
+    void* sq_ring_ = MAP_FAILED;
+    size_t sq_ring_size_ = 0;
+    void* cq_ring_ = MAP_FAILED;
+    size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_size_ = 0;
+    unsigned* sq_head_;
+    unsigned* sq_tail_;
+    unsigned* sq_array_;
+    unsigned sq_mask_;
+    unsigned* cq_head_;
+    unsigned* cq_tail_;
+    io_uring_cqe* cqes_;
+    unsigned cq_mask_;
+    unsigned queued_ = 0;
+};
+}  // namespace utils
+
+// Input stream keeping depth buffers of read-ahead in flight. Whole-buffer refills swap the
+// completed buffer in instead of copying it.
+class uring_istream : public istream {
+public:
+    static constexpr size_t kDefaultDepth = 4;
+
+    explicit uring_istream(int fd = STDIN_FILENO, size_t buffer_size = kDefaultBufferSize,
+                           size_t depth = kDefaultDepth);
+
+    ~uring_istream();
+
+    bool uses_uring() const;
+
+protected:
+    ssize_t read_buffer(char* data, size_t size, long long position) override;
+
+private:
+    struct chunk {
+        utils::buffer_ptr data;
+        size_t capacity;
+        long long position;
+        ssize_t size;
+        size_t consumed;
+        bool done;
+    };
+
+    void submit(chunk& request);
+
+    void wait(chunk& request);
+
+    void restart(long long position);
+
+    void recycle();
+
+    utils::io_ring ring_;
+    std::deque<chunk> chunks_;
+    size_t depth_;
+    long long next_position_ = 0;
+    bool positional_;
+};
+
+// Output stream submitting full buffers to io_uring without waiting for them. flush() waits for
+// every submitted buffer and moves the file position past them.
+class uring_ostream : public ostream {
+public:
+    static constexpr size_t kDefaultDepth = 4;
+
+    explicit uring_ostream(int fd = STDOUT_FILENO, size_t buffer_size = kDefaultBufferSize,
+                           size_t depth = kDefaultDepth);
+
+    ~uring_ostream();
+
+    ostream& flush() override;
+
+    bool uses_uring() const;
+
+protected:
+    void write_buffer() override;
+
+private:
+    struct chunk {
+        utils::buffer_ptr data;
+        size_t capacity;
+        long long position;
+        size_t size;
+        size_t written;
+        bool done;
+    };
+
+    void submit(chunk& request);
+
+    void complete(bool block);
+
+    void retire();
+
+    utils::io_ring ring_;
+    std::deque<chunk> chunks_;
+    std::vector<chunk> spare_;
+    size_t depth_;
+    long long position_ = 0;
+    bool positional_;
+};
+}  // namespace stdlike
@@ -1,19 +1,35 @@
 #include <errno.h>  // for debug
 #include <fcntl.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
+#include <array>
+#include <cctype>
 #include <chrono>
+#include <csignal>
 #include <fstream>
 #include <iostream>  // for debug
 #include <regex>
 #include <string_view>
+#include <thread>
+#include <vector>
 // #include <numbers>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
+#include "implementation/async_ostream.hpp"
+#include "implementation/binary.hpp"
+#include "implementation/compression.hpp"
+#include "implementation/coroutine.hpp"
+#include "implementation/fstream.hpp"
 #include "implementation/iostream.hpp"
+#include "implementation/parallel.hpp"
+#include "implementation/reactor.hpp"
+#include "implementation/print.hpp"
+#include "implementation/uring.hpp"
+#include "util.h"
 
 // NOLINTBEGIN
 using namespace stdlike;
@@ -276,6 +292,7 @@ TEST_CASE_METHOD(OutputTest, "Pointers") {
 }
 
 TEST_CASE_METHOD(OutputTest, "FlushingOutputBeforeInput") {
+    cin.tie(&cout);
     cout.flush();
     static constexpr std::string_view output_before_input = "Some Output!";
     cout << output_before_input.data() << '\n';
@@ -287,6 +304,74 @@ TEST_CASE_METHOD(OutputTest, "FlushingOutputBeforeInput") {
     REQUIRE_THAT(ExportOutput(), Catch::Matchers::Matches(output_before_input.data()));
 }
 
+TEST_CASE_METHOD(OutputTest, "Untie") {
+    cin.tie(&cout);
+    REQUIRE(cin.tie(nullptr) == &cout);
+    REQUIRE(cin.tie() == nullptr);
+    cout.flush();
+    REQUIRE(cout.empty());
+    static constexpr std::string_view pending_output = "Pending!";
+    cout << pending_output.data() << '\n';
+    REQUIRE_FALSE(cout.empty());
+
+    bool trigger;
+    cin >> trigger;
+    REQUIRE_THAT(ExportOutput(), Catch::Matchers::Matches("\0"));
+
+    cout.flush();
+    RestoreIfstream();
+    REQUIRE_THAT(ExportOutput(), Catch::Matchers::Matches(pending_output.data()));
+
+    cin.tie(&cout);
+    REQUIRE(istream(STDOUT_FILENO).tie() == nullptr);
+
+    istream auto_untied(STDIN_FILENO);
+    REQUIRE(auto_untied.tie() == &cout);
+    auto_untied >> trigger;
+    REQUIRE(auto_untied.tie() == nullptr);
+}
+
+TEST_CASE("TieFollowsThread") {
+    istream in(STDIN_FILENO);
+    REQUIRE(in.tie() == &cout);
+    ostream* other_cout = nullptr;
+    ostream* other_tie = nullptr;
+    std::thread([&] {
+        other_cout = &cout;
+        other_tie = in.tie();
+    }).join();
+    REQUIRE(other_tie == other_cout);
+    REQUIRE(other_cout != &cout);
+}
+
+TEST_CASE_METHOD(OutputTest, "ThreadRecords") {
+    constexpr int kThreads = 8;
+    constexpr int kLines = 5'000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t] {
+            std::string payload(40 + t * 7, static_cast<char>('a' + t));
+            for (int i = 0; i < kLines; ++i) {
+                cout << t << ' ' << i << ' ' << payload.c_str() << '\n';
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::ifstream output("../iostream/io_files/output.txt");
+    std::vector<int> next(kThreads, 0);
+    std::string line;
+    while (std::getline(output, line)) {
+        int t = line[0] - '0';
+        REQUIRE((t >= 0 && t < kThreads));
+        std::string expected = std::to_string(t) + ' ' + std::to_string(next[t]++) + ' ' +
+                               std::string(40 + t * 7, static_cast<char>('a' + t));
+        REQUIRE(line == expected);
+    }
+    REQUIRE(std::all_of(next.begin(), next.end(), [](int count) { return count == kLines; }));
+}
+
 TEST_CASE_METHOD(OutputTest, "NoWritePermissions") {
     ProhibitWritingToSTDOUT();
 
@@ -303,4 +388,1459 @@ TEST_CASE_METHOD(OutputTest, "NoWritePermissions") {
     AllowWritingToSTDOUT();
     cout.flush();  // clear buffer
 }
+
+TEST_CASE("PipeInput") {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    std::string data;
+    for (int i = 0; i < 10000; ++i) {
+        data += std::to_string(i) + ' ';
+    }
+    REQUIRE(write(fds[1], data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    close(fds[1]);
+
+    istream in(fds[0], 64);
+    REQUIRE(in.buffer_size() == 64);
+    int value;
+    for (int i = 0; i < 5000; ++i) {
+        in >> value;
+        REQUIRE(value == i);
+    }
+    in.set_buffer_size(1 << 20);
+    for (int i = 5000; i < 10000; ++i) {
+        in >> value;
+        REQUIRE(value == i);
+    }
+    REQUIRE_FALSE(in.fail());
+    in >> value;
+    REQUIRE(in.fail());
+    close(fds[0]);
+}
+
+TEST_CASE("MappedInput") {
+    int fd = open("../iostream/io_files/input.txt", O_RDONLY);
+    REQUIRE(fd != -1);
+    {
+        istream in(fd, input_mode::mapped);
+        REQUIRE(in.is_mapped());
+        char ch_num, ch_classic;
+        int num;
+        long long big_num;
+        double floating_num;
+        in >> ch_num >> ch_classic >> num >> big_num >> floating_num;
+        REQUIRE(ch_num == '1');
+        REQUIRE(ch_classic == 'c');
+        REQUIRE(num == 32);
+        REQUIRE(big_num == 8589934588);
+        REQUIRE(floating_num == 3.1415926535);
+        while (!in.fail()) {
+            in >> ch_num;
+        }
+    }
+    close(fd);
+
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(write(fds[1], "42", 2) == 2);
+    close(fds[1]);
+    istream in(fds[0], input_mode::mapped);
+    REQUIRE_FALSE(in.is_mapped());
+    int value;
+    in >> value;
+    REQUIRE(value == 42);
+    close(fds[0]);
+}
+
+TEST_CASE("IntegerFormatting") {
+    FILE *file = tmpfile();
+    int fd = fileno(file);
+    std::string expected;
+    for (size_t buffer_size : {1, 7, 64, 1 << 16}) {
+        ostream out(fd, buffer_size);
+        out << 0 << ' ' << -1 << ' ' << 9 << ' ' << 10 << ' ' << 99 << ' ' << 100 << ' ';
+        out << std::numeric_limits<long long>::min() << ' ' << std::numeric_limits<long long>::max()
+            << ' ' << std::numeric_limits<unsigned long long>::max() << ' '
+            << std::numeric_limits<short>::min() << ' ' << 1234567890u << ' '
+            << reinterpret_cast<const void *>(0xdeadbeef) << '\n';
+        expected += "0 -1 9 10 99 100 -9223372036854775808 9223372036854775807 "
+                    "18446744073709551615 -32768 1234567890 0xdeadbeef\n";
+    }
+    RandomGenerator rnd;
+    auto values = rnd.GenIntegralVector<int64_t>(1000, std::numeric_limits<int64_t>::min(),
+                                                 std::numeric_limits<int64_t>::max());
+    {
+        ostream out(fd);
+        for (auto value : values) {
+            out << value << ' ';
+            expected += std::to_string(value) + ' ';
+        }
+    }
+    std::string actual(expected.size(), '\0');
+    REQUIRE(pread(fd, actual.data(), actual.size(), 0) == static_cast<ssize_t>(expected.size()));
+    REQUIRE(actual == expected);
+    fclose(file);
+}
+
+TEST_CASE("FloatingFormatting") {
+    FILE *file = tmpfile();
+    int fd = fileno(file);
+    std::string expected;
+    {
+        ostream out(fd, 16);
+        out << 0.1 << ' ' << -2.5 << ' ' << 1e300 << ' ' << 5e-324 << ' ' << 0.3f << ' ';
+        out << std::numeric_limits<double>::infinity() << ' ' << 123456789012345678.0 << '\n';
+        expected += "0.1 -2.5 1e+300 5e-324 0.3 inf 123456789012345680\n";
+
+        out << fixed << 3.14159 << ' ' << 1e20 << ' ';
+        out.precision(2);
+        out << 2.675 << ' ' << scientific << 12345.678 << ' ' << defaultfloat << 1234.5 << '\n';
+        expected += "3.141590 100000000000000000000.000000 2.67 1.23e+04 1.2e+03\n";
+        out.precision(-1);
+        out << fixed << 1e300 << defaultfloat << '\n';
+        std::string huge(400, '\0');
+        huge.resize(snprintf(huge.data(), huge.size(), "%f\n", 1e300));
+        expected += huge;
+    }
+    std::string actual(expected.size(), '\0');
+    REQUIRE(pread(fd, actual.data(), actual.size(), 0) == static_cast<ssize_t>(expected.size()));
+    REQUIRE(actual == expected);
+
+    RandomGenerator rnd;
+    auto values = rnd.GenIntegralVector<uint64_t>(1000, 0, std::numeric_limits<uint64_t>::max());
+    REQUIRE(ftruncate(fd, 0) == 0);
+    REQUIRE(lseek(fd, 0, SEEK_SET) == 0);
+    {
+        ostream out(fd);
+        for (auto bits : values) {
+            double value = std::bit_cast<double>(bits);
+            if (std::isfinite(value)) {
+                out << value << ' ';
+            }
+        }
+    }
+    std::ifstream in("/proc/self/fd/" + std::to_string(fd));
+    for (auto bits : values) {
+        double value = std::bit_cast<double>(bits);
+        if (std::isfinite(value)) {
+            std::string text;
+            in >> text;
+            REQUIRE(std::strtod(text.c_str(), nullptr) == value);
+        }
+    }
+    fclose(file);
+}
+
+TEST_CASE("IntegerParsing") {
+    RandomGenerator rnd;
+    auto values = rnd.GenIntegralVector<int64_t>(5000, std::numeric_limits<int64_t>::min(),
+                                                 std::numeric_limits<int64_t>::max());
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(rnd.GenInt<int64_t>(-1000, 1000));
+    }
+    std::string data;
+    for (auto value : values) {
+        data += std::to_string(value) + (value % 3 == 0 ? "\n" : " ");
+    }
+    data += "000000000000000000000000042 18446744073709551615 18446744073709551616 "
+            "-9223372036854775809 99999999999999999999999 300 -129 7";
+
+    FILE *file = tmpfile();
+    int fd = fileno(file);
+    REQUIRE(write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    for (size_t buffer_size : {1, 13, 4096}) {
+        istream in(fd, buffer_size);
+        int64_t value;
+        for (auto expected : values) {
+            in >> value;
+            REQUIRE(value == expected);
+        }
+        REQUIRE_FALSE(in.fail());
+
+        in >> value;
+        REQUIRE(value == 42);
+        uint64_t unsigned_value;
+        in >> unsigned_value;
+        REQUIRE(unsigned_value == std::numeric_limits<uint64_t>::max());
+        REQUIRE_FALSE(in.fail());
+        in >> unsigned_value;
+        REQUIRE(unsigned_value == std::numeric_limits<uint64_t>::max());
+        REQUIRE(in.fail());
+        in >> value;
+        REQUIRE(value == std::numeric_limits<int64_t>::min());
+        REQUIRE(in.fail());
+        in >> value;
+        REQUIRE(value == std::numeric_limits<int64_t>::max());
+        REQUIRE(in.fail());
+        int8_t small;
+        in >> small;
+        REQUIRE(small == std::numeric_limits<int8_t>::max());
+        REQUIRE(in.fail());
+        in >> small;
+        REQUIRE(small == std::numeric_limits<int8_t>::min());
+        REQUIRE(in.fail());
+        in >> small;
+        REQUIRE(small == 7);
+        REQUIRE_FALSE(in.fail());
+    }
+    fclose(file);
+}
+
+TEST_CASE("FloatingParsing") {
+    RandomGenerator rnd;
+    auto values = rnd.GenIntegralVector<uint64_t>(3000, 0, std::numeric_limits<uint64_t>::max());
+    std::string data;
+    std::vector<double> expected;
+    for (auto bits : values) {
+        double value = std::bit_cast<double>(bits);
+        if (std::isfinite(value)) {
+            char text[64];
+            auto length = snprintf(text, sizeof(text), bits % 2 ? "%.17g " : "%.25e\n", value);
+            data.append(text, length);
+            expected.push_back(value);
+        }
+    }
+    data += "0.1 +2.5 1e5 -1E-5 .5 7. inf -Infinity nan 1e400 1e-400 12.5abc";
+
+    FILE *file = tmpfile();
+    int fd = fileno(file);
+    REQUIRE(write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    for (size_t buffer_size : {1, 13, 4096}) {
+        istream in(fd, buffer_size);
+        double value;
+        for (auto number : expected) {
+            in >> value;
+            REQUIRE(value == number);
+        }
+        REQUIRE_FALSE(in.fail());
+        for (double number : {0.1, 2.5, 1e5, -1e-5, 0.5, 7.0}) {
+            in >> value;
+            REQUIRE(value == number);
+        }
+        in >> value;
+        REQUIRE(value == std::numeric_limits<double>::infinity());
+        in >> value;
+        REQUIRE(value == -std::numeric_limits<double>::infinity());
+        in >> value;
+        REQUIRE(std::isnan(value));
+        REQUIRE_FALSE(in.fail());
+        in >> value;
+        REQUIRE(value == HUGE_VAL);
+        REQUIRE(in.fail());
+        in >> value;
+        REQUIRE(value == 0);
+        REQUIRE(in.fail());
+        float small;
+        in >> small;
+        REQUIRE(small == 12.5f);
+        REQUIRE_FALSE(in.fail());
+        char symbol;
+        in >> symbol;
+        REQUIRE(symbol == 'a');
+    }
+    fclose(file);
+
+    // The letters after the number never end while the pipe stays open, so the token has to be
+    // cut short instead of read to the end of the input.
+    std::string token = "2.5" + std::string(20000, 'e');
+    for (size_t buffer_size : {13, 1 << 16}) {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        REQUIRE(write(fds[1], token.data(), token.size()) == static_cast<ssize_t>(token.size()));
+        {
+            istream in(fds[0], buffer_size);
+            double value;
+            in >> value;
+            REQUIRE(value == 2.5);
+            REQUIRE_FALSE(in.fail());
+        }
+        close(fds[0]);
+        close(fds[1]);
+    }
+}
+
+TEST_CASE("SpaceScanning") {
+    RandomGenerator rnd;
+    for (int i = 0; i < 2000; ++i) {
+        std::string text = rnd.GenString(rnd.GenInt<size_t>(0, 100), '\x01', '\x7f');
+        for (auto &symbol : text) {
+            if (rnd.GenInt<int>(0, 3) == 0) {
+                symbol = " \f\n\r\t\v"[rnd.GenInt<int>(0, 5)];
+            }
+        }
+        const char *first = text.data();
+        const char *last = first + text.size();
+        auto is_space = [](char symbol) {
+            return std::isspace(static_cast<unsigned char>(symbol));
+        };
+        REQUIRE(utils::skip_spaces(first, last) == std::find_if_not(first, last, is_space));
+        REQUIRE(utils::find_space(first, last) == std::find_if(first, last, is_space));
+    }
+    std::string spaces(100, ' ');
+    spaces += "x";
+    REQUIRE(*utils::skip_spaces(spaces.data(), spaces.data() + spaces.size()) == 'x');
+}
+
+TEST_CASE("BulkWrite") {
+    FILE *file = tmpfile();
+    int fd = fileno(file);
+    std::string expected;
+    {
+        ostream out(fd, 16);
+        REQUIRE(out.buffer_size() == 16);
+        std::string small = "small";
+        std::string big(1000, 'b');
+        out.write(small.data(), small.size()).write(big.data(), big.size());
+        out << 'c';
+        out.set_buffer_size(1 << 20);
+        out.write(small.data(), small.size());
+        out << big.c_str();
+        expected = small + big + 'c' + small + big;
+    }
+    std::string actual(expected.size() + 1, '\0');
+    REQUIRE(pread(fd, actual.data(), actual.size(), 0) == static_cast<ssize_t>(expected.size()));
+    actual.pop_back();
+    REQUIRE(actual == expected);
+    fclose(file);
+}
+
+TEST_CASE("FileStreams") {
+    const char* path = "../iostream/io_files/fstream.txt";
+    {
+        ofstream out(path);
+        REQUIRE(out.is_open());
+        out << 1 << ' ' << -2 << ' ' << 3.5 << '\n';
+    }
+    {
+        ofstream out(path, O_APPEND);
+        out << "appended" << ' ' << 42 << '\n';
+        REQUIRE(out.advise(POSIX_FADV_DONTNEED));
+    }
+    {
+        ifstream in(path);
+        REQUIRE(in.is_open());
+        int a, b, c;
+        double d;
+        char word[9];
+        in >> a >> b >> d;
+        for (char& ch : word) {
+            ch = '\0';
+        }
+        for (int i = 0; i < 8; ++i) {
+            in >> word[i];
+        }
+        in >> c;
+        REQUIRE(!in.fail());
+        REQUIRE((a == 1 && b == -2 && d == 3.5 && c == 42));
+        REQUIRE(std::string_view(word) == "appended");
+        in.close();
+        REQUIRE(!in.is_open());
+    }
+    {
+        ifstream in(path, 0, input_mode::mapped);
+        int a;
+        in >> a;
+        REQUIRE(in.is_mapped());
+        REQUIRE(a == 1);
+    }
+    {
+        std::string big(100'000, 'x');
+        {
+            ofstream out(path, O_TRUNC | O_DIRECT, 1000);
+            REQUIRE(out.buffer_size() % 4096 == 0);
+            out.write(big.data(), big.size());
+            out << 7;
+        }
+        ifstream in(path, O_DIRECT, input_mode::buffered, 1000);
+        std::string actual;
+        char ch;
+        while (!(in >> ch).fail()) {
+            actual += ch;
+        }
+        REQUIRE(actual == big + '7');
+    }
+    unlink(path);
+
+    ifstream missing("../iostream/io_files/missing.txt");
+    REQUIRE(!missing.is_open());
+    REQUIRE(missing.fail());
+
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    REQUIRE(write(fds[1], "17 18", 5) == 5);
+    close(fds[1]);
+    fd_istream in(fds[0]);
+    int x, y;
+    in >> x >> y;
+    REQUIRE((x == 17 && y == 18));
+}
+
+TEST_CASE("AsyncOutput") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    std::string expected;
+    {
+        async_ostream out(fd, 64, 2);
+        for (int i = 0; i < 10'000; ++i) {
+            out << i << ' ';
+            expected += std::to_string(i) + ' ';
+        }
+        out.flush();
+        REQUIRE(out.backlog() == 0);
+        REQUIRE(!out.fail());
+        REQUIRE(lseek(fd, 0, SEEK_END) == static_cast<off_t>(expected.size()));
+
+        std::string big(1000, 'b');
+        out.write(big.data(), big.size());
+        out.set_buffer_size(16);
+        out << "tail";
+        expected += big + "tail";
+    }
+    std::string actual(expected.size() + 1, '\0');
+    REQUIRE(pread(fd, actual.data(), actual.size(), 0) == static_cast<ssize_t>(expected.size()));
+    actual.pop_back();
+    REQUIRE(actual == expected);
+    fclose(file);
+
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    close(fds[0]);
+    signal(SIGPIPE, SIG_IGN);
+    async_ostream broken(fds[1], 16);
+    broken << "this does not fit into a single buffer";
+    REQUIRE(broken.flush().fail());
+    close(fds[1]);
+}
+
+TEST_CASE("UringStreams") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    std::vector<long long> numbers;
+    std::vector<double> floats;
+    RandomGenerator rnd(7);
+    std::string expected;
+    {
+        uring_ostream out(fd, 100, 3);
+        for (int i = 0; i < 20'000; ++i) {
+            numbers.push_back(rnd.GenInt<long long>());
+            floats.push_back(rnd.GenRealArray<1>(-1e6, 1e6)[0]);
+            out << numbers.back() << ' ' << floats.back() << '\n';
+        }
+        out.flush();
+        REQUIRE(!out.fail());
+        out << "tail";
+    }
+    REQUIRE(lseek(fd, 0, SEEK_CUR) == lseek(fd, 0, SEEK_END));
+    {
+        ostream out(fd);
+        out << " end";
+    }
+    for (size_t buffer_size : {size_t{64}, size_t{4096}, size_t{1} << 16}) {
+        uring_istream in(fd, buffer_size, 4);
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            long long number;
+            double floating;
+            in >> number >> floating;
+            REQUIRE(number == numbers[i]);
+            REQUIRE(floating == floats[i]);
+        }
+        std::string tail;
+        char symbol;
+        while (!(in >> symbol).fail()) {
+            tail += symbol;
+        }
+        REQUIRE(tail == "tailend");
+    }
+    fclose(file);
+
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    std::thread writer([fd = fds[1]] {
+        uring_ostream out(fd, 128);
+        for (int i = 0; i < 10'000; ++i) {
+            out << i << '\n';
+        }
+        out.flush();
+        close(fd);
+    });
+    uring_istream in(fds[0], 256);
+    for (int i = 0; i < 10'000; ++i) {
+        int value;
+        in >> value;
+        REQUIRE(value == i);
+    }
+    int value;
+    in >> value;
+    REQUIRE(in.fail());
+    writer.join();
+    close(fds[0]);
+}
+
+TEST_CASE("CommitRecords") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    record_ostream out(fd, record_mode::commit, 16);
+    out << "first " << 1 << '\n' << "still first";
+    REQUIRE(lseek(fd, 0, SEEK_END) == 0);
+    std::string big(100, 'x');
+    out.write(big.data(), big.size());
+    REQUIRE(lseek(fd, 0, SEEK_END) == 0);
+    REQUIRE(out.buffer_size() >= 100);
+    out.commit();
+    std::string expected = "first 1\nstill first" + big;
+    REQUIRE(lseek(fd, 0, SEEK_END) == static_cast<off_t>(expected.size()));
+
+    record_ostream lines(fd, record_mode::line, 16);
+    lines << "a complete line\n" << "partial";
+    lines.set_buffer_size(8);
+    lines << " line" << '\n' << "rest";
+    expected += "a complete line\npartial line\n";
+    REQUIRE(lseek(fd, 0, SEEK_END) <= static_cast<off_t>(expected.size()));
+    lines.flush();
+    expected += "rest";
+    std::string actual(expected.size() + 1, '\0');
+    REQUIRE(pread(fd, actual.data(), actual.size(), 0) == static_cast<ssize_t>(expected.size()));
+    actual.pop_back();
+    REQUIRE(actual == expected);
+    fclose(file);
+}
+
+TEST_CASE("LongRecords") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    record_ostream out(fd, record_mode::line, 16, 64);
+    std::string expected;
+    for (int i = 0; i < 10'000; ++i) {
+        out << i << ' ';
+        expected += std::to_string(i) + ' ';
+    }
+    REQUIRE(out.buffer_size() <= 256);
+    REQUIRE(lseek(fd, 0, SEEK_END) > 0);
+    out.flush();
+    std::string actual(expected.size() + 1, '\0');
+    REQUIRE(pread(fd, actual.data(), actual.size(), 0) == static_cast<ssize_t>(expected.size()));
+    actual.pop_back();
+    REQUIRE(actual == expected);
+    fclose(file);
+}
+
+TEST_CASE("TokenReading") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    std::string long_token(100, 't');
+    std::string text = "  alpha beta\t" + long_token + "\nname,age,city\n\nlast line";
+    REQUIRE(write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size()));
+
+    for (size_t buffer_size : {size_t{4}, size_t{16}, size_t{1} << 16}) {
+        istream in(fd, buffer_size);
+        REQUIRE(in.read_token() == "alpha");
+        std::string word;
+        in >> word;
+        REQUIRE(word == "beta");
+        REQUIRE(in.read_token() == long_token);
+        REQUIRE(in.getline().empty());
+        REQUIRE(in.getline(',') == "name");
+        REQUIRE(in.getline(',') == "age");
+        REQUIRE(in.getline() == "city");
+        REQUIRE(!in.fail());
+        std::string line = "not empty";
+        in.getline(line);
+        REQUIRE((line.empty() && !in.fail()));
+        REQUIRE(in.getline() == "last line");
+        REQUIRE(in.getline().empty());
+        REQUIRE(in.fail());
+        REQUIRE(in.read_token().empty());
+        REQUIRE(in.fail());
+    }
+
+    istream mapped(fd, input_mode::mapped);
+    REQUIRE(mapped.getline() == "  alpha beta\t" + long_token);
+    REQUIRE(mapped.read_token() == "name,age,city");
+    fclose(file);
+}
+
+TEST_CASE("Print") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    auto read_all = [fd] {
+        std::string result(lseek(fd, 0, SEEK_END), '\0');
+        REQUIRE(pread(fd, result.data(), result.size(), 0) == static_cast<ssize_t>(result.size()));
+        ftruncate(fd, 0);
+        lseek(fd, 0, SEEK_SET);
+        return result;
+    };
+    for (size_t buffer_size : {size_t{8}, size_t{1} << 16}) {
+        {
+            ostream out(fd, buffer_size);
+            print(out, "{} {} {} {}\n", std::numeric_limits<int64_t>::min(),
+                  std::numeric_limits<uint64_t>::max(), 0, -7);
+            print(out, "{} {} [{}] {}{}\n", true, false, 'x', "text", std::string("string"));
+            print(out, "{{}} {{{}}} }}{{\n", 42);
+            print(out, "no arguments\n");
+        }
+        REQUIRE(read_all() ==
+                "-9223372036854775808 18446744073709551615 0 -7\n"
+                "true false [x] textstring\n"
+                "{} {42} }{\n"
+                "no arguments\n");
+
+        RandomGenerator rnd(buffer_size);
+        for (int i = 0; i < 1000; ++i) {
+            double value = rnd.GenRealArray<1>(-1e10, 1e10)[0] * (i % 2 == 0 ? 1 : 1e-12);
+            {
+                ostream out(fd, buffer_size);
+                print(out, "{:.3f}|{:e}|{:.10g}|{}", value, value, value, value);
+            }
+            char expected[256];
+            char shortest[32];
+            *std::to_chars(shortest, shortest + 31, value).ptr = '\0';
+            snprintf(expected, sizeof(expected), "%.3f|%e|%.10g|%s", value, value, value,
+                     shortest);
+            REQUIRE(read_all() == expected);
+        }
+
+        int local = 0;
+        std::string via_print;
+        {
+            ostream out(fd, buffer_size);
+            print(out, "{} {}", &local, nullptr);
+        }
+        via_print = read_all();
+        {
+            ostream out(fd, buffer_size);
+            out << static_cast<const void*>(&local) << " 0x0";
+        }
+        REQUIRE(via_print == read_all());
+
+        std::string big(1000, 'b');
+        {
+            ostream out(fd, buffer_size);
+            print(out, "<{}> {:.2f}", big, 1e300);
+        }
+        std::vector<char> huge(400);
+        snprintf(huge.data(), huge.size(), "%.2f", 1e300);
+        REQUIRE(read_all() == "<" + big + "> " + huge.data());
+    }
+    fclose(file);
+}
+
+TEST_CASE("BinaryStreams") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    RandomGenerator rnd(42);
+    auto ints = rnd.GenIntegralVector<int64_t>(10'000, std::numeric_limits<int64_t>::min(),
+                                               std::numeric_limits<int64_t>::max());
+    auto small = rnd.GenIntegralVector<int32_t>(10'000, -1000, 1000);
+    auto doubles = rnd.GenRealArray<100>(-1e9, 1e9);
+
+    for (auto encoding : {binary_encoding::fixed, binary_encoding::varint}) {
+        ftruncate(fd, 0);
+        lseek(fd, 0, SEEK_SET);
+        {
+            ostream out(fd, 64);
+            binary_ostream binary(out, encoding);
+            binary << uint8_t{200} << int16_t{-300} << true << 2.5f << uint64_t{1} << int64_t{-1};
+            binary.write(std::span<const int64_t>(ints));
+            binary.write(std::span<const int32_t>(small));
+            binary.write(std::span<const double>(doubles));
+            binary << std::numeric_limits<uint64_t>::max() << std::numeric_limits<int64_t>::min();
+        }
+        off_t size = lseek(fd, 0, SEEK_END);
+        if (encoding == binary_encoding::fixed) {
+            REQUIRE(size == static_cast<off_t>(1 + 2 + 1 + 4 + 8 + 8 + ints.size() * 8 +
+                                               small.size() * 4 + doubles.size() * 8 + 16));
+        }
+        for (size_t buffer_size : {size_t{16}, size_t{4096}}) {
+            istream in(fd, buffer_size);
+            binary_istream binary(in, encoding);
+            uint8_t byte;
+            int16_t word;
+            bool flag;
+            float single;
+            uint64_t one;
+            int64_t minus_one;
+            binary >> byte >> word >> flag >> single >> one >> minus_one;
+            REQUIRE((byte == 200 && word == -300 && flag && single == 2.5f));
+            REQUIRE((one == 1 && minus_one == -1));
+            std::vector<int64_t> ints_back(ints.size());
+            std::vector<int32_t> small_back(small.size());
+            std::array<double, 100> doubles_back;
+            binary.read(std::span<int64_t>(ints_back));
+            binary.read(std::span<int32_t>(small_back));
+            binary.read(std::span<double>(doubles_back));
+            REQUIRE(ints_back == ints);
+            REQUIRE(small_back == small);
+            REQUIRE(doubles_back == doubles);
+            uint64_t max;
+            int64_t min;
+            binary >> max >> min;
+            REQUIRE((max == std::numeric_limits<uint64_t>::max() &&
+                     min == std::numeric_limits<int64_t>::min()));
+            REQUIRE(!binary.fail());
+            binary >> byte;
+            REQUIRE(binary.fail());
+        }
+    }
+
+    ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    {
+        ostream out(fd);
+        binary_ostream binary(out, binary_encoding::varint);
+        binary << 300 << uint64_t{1} << uint64_t{1} << uint64_t{1};
+        const char overlong[] = "\xff\xff\xff\xff\xff\xff\xff\xff\xff\x7f";
+        out.write(overlong, 10);
+    }
+    istream in(fd);
+    binary_istream binary(in, binary_encoding::varint);
+    int8_t narrow;
+    binary >> narrow;
+    REQUIRE(binary.fail());
+    uint64_t value;
+    binary >> value >> value >> value;
+    binary >> value;
+    REQUIRE(binary.fail());
+
+    ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    REQUIRE(write(fd, "\x01\x00\x02\x01\x01\x01\x05", 7) == 7);
+    istream bools(fd);
+    binary_istream fixed(bools);
+    bool flags[3];
+    fixed >> flags[0] >> flags[1];
+    REQUIRE((flags[0] && !flags[1] && !fixed.fail()));
+    fixed >> flags[2];
+    REQUIRE(fixed.fail());
+    fixed >> flags[0];
+    REQUIRE((flags[0] && fixed.fail()));
+    fixed.clear();
+    fixed.read(std::span<bool>(flags, 2));
+    REQUIRE((flags[0] && flags[1] && !fixed.fail()));
+    fixed >> flags[2];
+    REQUIRE(fixed.fail());
+    fclose(file);
+}
+
+TEST_CASE("RangeIO") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    RandomGenerator rnd(43);
+    auto ints = rnd.GenIntegralVector<int64_t>(10'000, std::numeric_limits<int64_t>::min(),
+                                               std::numeric_limits<int64_t>::max());
+    auto small = rnd.GenIntegralVector<int16_t>(1'000, -1000, 1000);
+    auto doubles = rnd.GenRealArray<1000>(-1e9, 1e9);
+    {
+        ostream out(fd, 100);
+        out.write_range(ints).put('\n');
+        out.write_range(small, ",\n  ").put('\n');
+        out.write_range(doubles, "\t").put('\n');
+        out.write_range(std::vector<int>{}).write_range(std::array{'a', 'b'}, "-") << '\n';
+    }
+    std::string expected;
+    for (size_t i = 0; i < small.size(); ++i) {
+        expected += (i == 0 ? "" : ",\n  ") + std::to_string(small[i]);
+    }
+    std::ifstream text("/proc/self/fd/" + std::to_string(fd));
+    std::string line;
+    std::getline(text, line);
+    REQUIRE(line.size() > ints.size() * 10);
+    std::string smalls;
+    while (std::getline(text, line) && line.find('\t') == std::string::npos) {
+        smalls += (smalls.empty() ? "" : "\n") + line;
+    }
+    REQUIRE(smalls == expected);
+    std::getline(text, line);
+    REQUIRE(line == "a-b");
+
+    for (size_t buffer_size : {size_t{1}, size_t{7}, size_t{4096}}) {
+        lseek(fd, 0, SEEK_SET);
+        istream in(fd, buffer_size);
+        std::vector<int64_t> ints_back(ints.size());
+        std::vector<int16_t> small_back(small.size());
+        std::array<double, 1000> doubles_back;
+        in.read_n(std::span(ints_back));
+        REQUIRE(ints_back == ints);
+        for (int16_t& value : small_back) {
+            char comma;
+            in >> value;
+            if (&value != &small_back.back()) {
+                in >> comma;
+            }
+        }
+        REQUIRE(small_back == small);
+        in.read_n(std::span(doubles_back));
+        REQUIRE(doubles_back == doubles);
+        REQUIRE(!in.fail());
+        int rest;
+        REQUIRE(in.read_n(std::span(&rest, 1)).fail());
+    }
+
+    ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    std::string input =
+        "1 -2 3  99999999999999999999 -7\n4294967295 4294967296 -0 1e3 +2.5 0x10 .5 abc";
+    write(fd, input.data(), input.size());
+    lseek(fd, 0, SEEK_SET);
+    istream in(fd);
+    std::array<int32_t, 5> values{};
+    in.read_n(std::span(values));
+    REQUIRE(in.fail());
+    REQUIRE(values == std::array<int32_t, 5>{1, -2, 3, std::numeric_limits<int32_t>::max(), 0});
+    in.read_n(std::span(values.data(), 1));
+    REQUIRE((!in.fail() && values[0] == -7));
+    std::array<uint32_t, 3> unsigned_values{};
+    in.read_n(std::span(unsigned_values));
+    REQUIRE(in.fail());
+    REQUIRE(unsigned_values == std::array<uint32_t, 3>{std::numeric_limits<uint32_t>::max(),
+                                                       std::numeric_limits<uint32_t>::max(), 0});
+    std::array<double, 4> reals{};
+    REQUIRE(!in.read_n(std::span(reals)).fail());
+    REQUIRE(reals == std::array<double, 4>{-0.0, 1e3, 2.5, 0});
+    REQUIRE(in.read_n(std::span(reals)).fail());
+
+    ftruncate(fd, 0);
+    lseek(fd, 0, SEEK_SET);
+    input = "12 34 56789012 x";
+    write(fd, input.data(), input.size());
+    lseek(fd, 0, SEEK_SET);
+    istream chars(fd);
+    std::array<char, 5> symbols{};
+    REQUIRE(!chars.read_n(std::span(symbols)).fail());
+    REQUIRE(std::string_view(symbols.data(), symbols.size()) == "12345");
+    fclose(file);
+}
+
+TEST_CASE("ParallelParse") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    RandomGenerator rnd(45);
+    auto ints = rnd.GenIntegralVector<int64_t>(1'000'000, std::numeric_limits<int64_t>::min(),
+                                               std::numeric_limits<int64_t>::max());
+    {
+        ostream out(fd);
+        out << "header ";
+        for (int64_t value : ints) {
+            out << value << (rnd.GenInt(0, 9) == 0 ? "\n\t " : " ");
+        }
+    }
+    for (size_t threads : {1, 3, 8}) {
+        lseek(fd, 7, SEEK_SET);
+        parallel_parser parser(fd, threads);
+        REQUIRE(lseek(fd, 0, SEEK_CUR) == lseek(fd, 0, SEEK_END));
+        REQUIRE(parser.parse<int64_t>() == ints);
+        REQUIRE(!parser.fail());
+        auto narrow = parser.parse<int32_t>();
+        REQUIRE(parser.fail());
+        REQUIRE(narrow.size() < ints.size());
+    }
+
+    int pipe_fds[2];
+    REQUIRE(pipe(pipe_fds) == 0);
+    std::thread writer([&] {
+        ostream out(pipe_fds[1]);
+        out << "1.5 -2e3\n" << 0.25 << " 7 x 8";
+        out.flush();
+        close(pipe_fds[1]);
+    });
+    parallel_parser parser(pipe_fds[0], 4);
+    writer.join();
+    close(pipe_fds[0]);
+    REQUIRE(parser.parse<double>() == std::vector<double>{1.5, -2e3, 0.25, 7});
+    REQUIRE(parser.fail());
+
+    // Reading the write end of a pipe fails, and parsing must not hide it.
+    REQUIRE(pipe(pipe_fds) == 0);
+    parallel_parser unreadable(pipe_fds[1]);
+    REQUIRE(unreadable.fail());
+    REQUIRE(unreadable.parse<int>().empty());
+    REQUIRE(unreadable.fail());
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    fclose(file);
+}
+
+TEST_CASE("CompressedStreams") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    RandomGenerator rnd(46);
+    auto ints = rnd.GenIntegralVector<int64_t>(200'000, -1'000'000, 1'000'000);
+    auto rewind = [fd](bool truncate) {
+        if (truncate) {
+            ftruncate(fd, 0);
+        }
+        lseek(fd, 0, SEEK_SET);
+    };
+    auto read_back = [&](istream& in) {
+        std::vector<int64_t> values(ints.size());
+        in.read_n(std::span(values));
+        REQUIRE(!in.fail());
+        REQUIRE(values == ints);
+        int64_t extra;
+        REQUIRE((in >> extra).fail());
+    };
+
+    for (compression format : {compression::gzip, compression::zstd}) {
+        if (!supports(format)) {
+            REQUIRE(filter_ostream(fd, format).fail());
+            REQUIRE(filter_istream(fd, format).fail());
+            continue;
+        }
+        for (size_t buffer_size : {size_t{100}, size_t{1} << 16}) {
+            rewind(true);
+            {
+                filter_ostream out(fd, format, 1, buffer_size);
+                out.write_range(ints);
+                REQUIRE(!out.fail());
+            }
+            REQUIRE(lseek(fd, 0, SEEK_END) < static_cast<off_t>(ints.size() * 4));
+            for (compression input : {format, compression::automatic}) {
+                rewind(false);
+                filter_istream in(fd, input, buffer_size);
+                read_back(in);
+            }
+        }
+    }
+
+    struct failing_encoder : encoder {
+        encode_status encode(const char*&, const char*, char*&, char*, flush_mode) override {
+            return encode_status::failed;
+        }
+    };
+    {
+        filter_ostream out(fd, std::make_unique<failing_encoder>(), 16);
+        REQUIRE(!out.fail());
+        out << "more than sixteen bytes of data";
+        REQUIRE(out.fail());
+        out.flush();
+        REQUIRE(out.fail());
+    }
+
+    rewind(true);
+    {
+        ostream out(fd);
+        out.write_range(ints);
+    }
+    rewind(false);
+    {
+        filter_istream in(fd);
+        read_back(in);
+    }
+    rewind(false);
+    {
+        filter_istream in(fd, compression::gzip);
+        int64_t value;
+        REQUIRE((in >> value).fail());
+    }
+
+    if (!supports(compression::gzip)) {
+        fclose(file);
+        return;
+    }
+
+    rewind(true);
+    {
+        filter_ostream out(fd);
+        out << "first ";
+        out.flush();
+        REQUIRE(!out.fail());
+        rewind(false);
+        filter_istream in(fd);
+        std::string word;
+        REQUIRE(!(in >> word).fail());
+        REQUIRE(word == "first");
+        lseek(fd, 0, SEEK_END);
+        out << "second";
+        out.finish();
+        out << " third";
+    }
+    rewind(false);
+    {
+        filter_istream in(fd, compression::gzip);
+        std::string words[3];
+        in >> words[0] >> words[1] >> words[2];
+        REQUIRE((words[0] == "first" && words[1] == "second" && words[2] == "third"));
+        REQUIRE(!in.fail());
+    }
+
+    // Flushing with no data pending must not leave an unfinished stream behind.
+    for (bool finished : {false, true}) {
+        rewind(true);
+        off_t size = 0;
+        {
+            filter_ostream out(fd);
+            if (finished) {
+                out << "data";
+                out.finish();
+                size = lseek(fd, 0, SEEK_END);
+            }
+            out.flush();
+            REQUIRE(!out.fail());
+        }
+        REQUIRE(lseek(fd, 0, SEEK_END) == size);
+        rewind(false);
+        filter_istream in(fd, finished ? compression::gzip : compression::automatic);
+        std::string word;
+        in >> word;
+        REQUIRE(word == (finished ? "data" : ""));
+        REQUIRE(in.eof());
+        REQUIRE(!in.bad());
+    }
+
+    rewind(true);
+    {
+        filter_ostream out(fd);
+        out << "1 2 3 4";
+    }
+    off_t size = lseek(fd, 0, SEEK_END);
+    pwrite(fd, "\xff\xff\xff\xff", 4, size / 2);
+    rewind(false);
+    {
+        filter_istream in(fd);
+        int64_t value;
+        REQUIRE((in >> value >> value >> value >> value).fail());
+    }
+    fclose(file);
+}
+
+TEST_CASE("StreamStates") {
+    struct counting_istream : memory_istream {
+        using memory_istream::memory_istream;
+
+        ssize_t read_buffer(char* data, size_t size, long long position) override {
+            ++reads;
+            return memory_istream::read_buffer(data, size, position);
+        }
+
+        int reads = 0;
+    };
+
+    counting_istream counted("1 2", 2);
+    int value;
+    REQUIRE(counted.good());
+    REQUIRE(!(counted >> value >> value).fail());
+    REQUIRE(value == 2);
+    REQUIRE(counted.eof());
+    REQUIRE(!counted.fail());
+    int reads = counted.reads;
+    REQUIRE((counted >> value).fail());
+    for (int i = 0; i < 10; ++i) {
+        counted.peek();
+        counted.read_token();
+    }
+    REQUIRE(counted.reads == reads);
+    REQUIRE((counted.eof() && counted.fail() && !counted.bad() && !counted.good()));
+    counted.clear();
+    REQUIRE(counted.good());
+    REQUIRE((counted >> value).fail());
+    REQUIRE(counted.reads == reads + 1);
+
+    istream broken(-1);
+    REQUIRE((broken >> value).fail());
+    REQUIRE((broken.bad() && !broken.eof() && !broken.would_block()));
+
+    int sockets[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+    auto send = [&](std::string_view data) {
+        REQUIRE(write(sockets[1], data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    };
+    {
+        istream in(sockets[0], 4);
+        REQUIRE(in.set_nonblocking(true));
+        REQUIRE((in >> value).fail());
+        REQUIRE((in.would_block() && !in.eof() && !in.bad()));
+        send("  12");
+        REQUIRE((in >> value).fail());
+        in.clear();
+        REQUIRE((in >> value).fail());
+        REQUIRE(in.would_block());
+        send("345 6.2");
+        in.clear();
+        REQUIRE(!(in >> value).fail());
+        REQUIRE(value == 12345);
+        double real;
+        REQUIRE((in >> real).fail());
+        REQUIRE(in.would_block());
+        send("5 token");
+        in.clear();
+        REQUIRE((!(in >> real).fail() && real == 6.25));
+        REQUIRE((in.read_token().empty() && in.would_block()));
+        send("s\npartial");
+        in.clear();
+        REQUIRE(in.read_token() == "tokens");
+        REQUIRE((in.getline().empty() && !in.fail()));
+        REQUIRE((in.getline().empty() && in.would_block()));
+        send(" line\nlast");
+        in.clear();
+        REQUIRE(in.getline() == "partial line");
+        shutdown(sockets[1], SHUT_WR);
+        REQUIRE((in.read_token() == "last" && !in.fail()));
+        REQUIRE((in >> value).fail());
+        REQUIRE((in.eof() && !in.would_block()));
+    }
+    close(sockets[0]);
+    close(sockets[1]);
+
+    int pipe_fds[2];
+    REQUIRE(pipe(pipe_fds) == 0);
+    fcntl(pipe_fds[0], F_SETFL, fcntl(pipe_fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(pipe_fds[1], F_SETFL, fcntl(pipe_fds[1], F_GETFL) | O_NONBLOCK);
+    bool written = false;
+    std::thread writer([&] {
+        ostream out(pipe_fds[1], 1 << 20);
+        std::string block(1 << 20, 'x');
+        out << 1 << ' ';
+        out.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        out.write(block.data(), block.size()).write(" 2", 2);
+        written = !out.flush().fail();
+        close(pipe_fds[1]);
+    });
+    istream in(pipe_fds[0]);
+    std::string block;
+    REQUIRE(!(in >> value >> block >> reads).fail());
+    REQUIRE((value == 1 && block.size() == 1 << 20 && reads == 2));
+    writer.join();
+    REQUIRE(written);
+    close(pipe_fds[0]);
+}
+
+TEST_CASE("Reactor") {
+    constexpr int kConnections = 4;
+    constexpr int kValues = 100'000;
+    struct connection {
+        int sockets[2];
+        std::unique_ptr<nonblocking_istream> server_in;
+        std::unique_ptr<nonblocking_ostream> server_out;
+        std::unique_ptr<nonblocking_istream> client_in;
+        std::unique_ptr<nonblocking_ostream> client_out;
+        int64_t received = 0;
+        int64_t sum = 0;
+        bool done = false;
+    };
+
+    reactor loop;
+    REQUIRE(loop.valid());
+    std::vector<connection> connections(kConnections);
+    int finished = 0;
+    for (int i = 0; i < kConnections; ++i) {
+        connection& peer = connections[i];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, peer.sockets) == 0);
+        peer.server_in = std::make_unique<nonblocking_istream>(peer.sockets[0], 1000);
+        peer.server_out = std::make_unique<nonblocking_ostream>(peer.sockets[0], 1000);
+        peer.client_in = std::make_unique<nonblocking_istream>(peer.sockets[1], 1000);
+        peer.client_out = std::make_unique<nonblocking_ostream>(peer.sockets[1], 1000);
+
+        // Echoes every number doubled until the client shuts its side down.
+        REQUIRE(loop.add(peer.sockets[0], [&loop, &peer](uint32_t) {
+            peer.server_in->clear();
+            int64_t value;
+            while (!(*peer.server_in >> value).fail()) {
+                *peer.server_out << value * 2 << ' ';
+            }
+            if (peer.server_in->eof()) {
+                *peer.server_out << -1 << '\n';
+                loop.remove(peer.sockets[0]);
+            }
+            loop.flush(*peer.server_out);
+        }));
+        REQUIRE(loop.add(peer.sockets[1], [&loop, &peer, &finished](uint32_t) {
+            peer.client_in->clear();
+            int64_t value;
+            while (!(*peer.client_in >> value).fail()) {
+                if (value == -1) {
+                    peer.done = true;
+                    loop.remove(peer.sockets[1]);
+                    ++finished;
+                    return;
+                }
+                ++peer.received;
+                peer.sum += value;
+            }
+        }));
+
+        for (int value = 0; value < kValues; ++value) {
+            *peer.client_out << i * kValues + value << (value % 1000 == 0 ? "\n" : " ");
+        }
+        REQUIRE(loop.flush(*peer.client_out));
+        REQUIRE(peer.client_out->pending() > 0);
+    }
+
+    bool shut = false;
+    for (int rounds = 0; finished < kConnections && rounds < 100'000; ++rounds) {
+        REQUIRE(loop.run_once(1000) >= 0);
+        bool sent = std::all_of(connections.begin(), connections.end(), [](const auto& peer) {
+            return peer.client_out->pending() == 0;
+        });
+        if (sent && !shut) {
+            shut = true;
+            for (connection& peer : connections) {
+                shutdown(peer.sockets[1], SHUT_WR);
+            }
+        }
+    }
+    REQUIRE(finished == kConnections);
+    REQUIRE(loop.size() == 0);
+    for (int i = 0; i < kConnections; ++i) {
+        connection& peer = connections[i];
+        REQUIRE(peer.received == kValues);
+        int64_t first = static_cast<int64_t>(i) * kValues;
+        REQUIRE(peer.sum == (first * 2 + kValues - 1) * kValues);
+        REQUIRE(!peer.server_out->fail());
+        peer.server_in.reset();
+        peer.server_out.reset();
+        peer.client_in.reset();
+        peer.client_out.reset();
+        close(peer.sockets[0]);
+        close(peer.sockets[1]);
+    }
+
+    // Nobody reads the other end, so the queue fills up and further output is refused.
+    int sockets[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+    {
+        nonblocking_ostream out(sockets[1], 1000, 10'000);
+        std::string line(99, 'x');
+        while (!out.fail()) {
+            out.write(line.data(), line.size()).put('\n');
+        }
+        REQUIRE(out.would_block());
+        REQUIRE(out.pending() <= 10'000 + 1000);
+        REQUIRE(out.flush().fail());
+        std::vector<char> drain(1 << 16);
+        while (out.pending() > 0) {
+            REQUIRE(read(sockets[0], drain.data(), drain.size()) > 0);
+            out.flush();
+        }
+        out.clear();
+        REQUIRE(!out.write(line.data(), line.size()).flush().fail());
+        REQUIRE(!out.would_block());
+    }
+    close(sockets[0]);
+    close(sockets[1]);
+}
+
+TEST_CASE("IntegerBases") {
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        char value = static_cast<char>(symbol);
+        REQUIRE(utils::isspace(value) == (std::isspace(symbol) != 0));
+        REQUIRE(utils::isdigit(value) == (std::isdigit(symbol) != 0));
+        REQUIRE(utils::has_class(value, utils::kHexClass) == (std::isxdigit(symbol) != 0));
+        REQUIRE(utils::has_class(value, utils::kAlphaClass) == (std::isalpha(symbol) != 0));
+        REQUIRE(utils::has_class(value, utils::kSignClass) == (value == '+' || value == '-'));
+    }
+    REQUIRE(utils::digit_value('7') == 7);
+    REQUIRE(utils::digit_value('F') == 15);
+    REQUIRE(utils::digit_value('z') == 35);
+    REQUIRE(utils::digit_value('/') == utils::kNotDigit);
+    REQUIRE(utils::is_number_char(')'));
+    REQUIRE(!utils::is_number_char(','));
+
+    for (size_t buffer_size : {size_t{1}, size_t{2}, size_t{4096}}) {
+        memory_istream in("ff 0x1F -0x10 7fffffffffffffff 0xg 17 -10 8 0x1f 017 42 0 1011 123 "
+                          "a b c",
+                          buffer_size);
+        int64_t value;
+        REQUIRE(in.base() == 10);
+        REQUIRE(!(in >> hex >> value).fail());
+        REQUIRE(value == 255);
+        REQUIRE(!(in >> value).fail());
+        REQUIRE(value == 31);
+        REQUIRE(!(in >> value).fail());
+        REQUIRE(value == -16);
+        REQUIRE(!(in >> value).fail());
+        REQUIRE(value == std::numeric_limits<int64_t>::max());
+        REQUIRE(!(in >> value).fail());
+        REQUIRE(value == 0);
+        REQUIRE((in >> value).fail());
+        REQUIRE(in.read_token() == "xg");
+
+        REQUIRE(!(in >> oct >> value).fail());
+        REQUIRE(value == 15);
+        REQUIRE(!(in >> value).fail());
+        REQUIRE(value == -8);
+        REQUIRE((in >> value).fail());
+        REQUIRE(in.read_token() == "8");
+
+        in.base(0);
+        for (int64_t expected : {31, 15, 42, 0}) {
+            REQUIRE(!(in >> value).fail());
+            REQUIRE(value == expected);
+        }
+        REQUIRE(in.base(2).base(37).base() == 2);
+        REQUIRE(!(in >> value).fail());
+        REQUIRE(value == 11);
+        REQUIRE(!(in >> dec >> value).fail());
+        REQUIRE(value == 123);
+
+        std::vector<int16_t> values(3);
+        REQUIRE(!(in >> hex).read_n(std::span(values)).fail());
+        REQUIRE(values == std::vector<int16_t>{10, 11, 12});
+    }
+
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    int local = 0;
+    {
+        ostream out(fd);
+        out << static_cast<const void*>(&local) << ' ' << static_cast<const void*>(nullptr)
+            << " DEADBEEF 0X10 xyz";
+    }
+    lseek(fd, 0, SEEK_SET);
+    istream in(fd);
+    void* address;
+    REQUIRE(!(in >> address).fail());
+    REQUIRE(address == &local);
+    REQUIRE(!(in >> address).fail());
+    REQUIRE(address == nullptr);
+    REQUIRE(!(in >> address).fail());
+    REQUIRE(address == reinterpret_cast<void*>(0xdeadbeef));
+    REQUIRE(!(in >> address).fail());
+    REQUIRE(address == reinterpret_cast<void*>(0x10));
+    REQUIRE((in >> address).fail());
+    REQUIRE(address == nullptr);
+    REQUIRE(in.base() == 10);
+    fclose(file);
+}
+
+task<int64_t> sum_values(awaitable_istream& in) {
+    int64_t sum = 0;
+    int64_t value;
+    while (true) {
+        ssize_t size = co_await in.read_some();
+        while (!(in >> value).fail()) {
+            sum += value;
+        }
+        if (size <= 0) {
+            co_return sum;
+        }
+    }
+}
+
+task<> receive_values(awaitable_istream& in, int64_t& sum, int& finished) {
+    sum = co_await sum_values(in);
+    ++finished;
+}
+
+task<> send_values(awaitable_ostream& out, int count) {
+    for (int value = 1; value <= count; ++value) {
+        out << value << ' ';
+        if (value % 4096 == 0) {
+            co_await out.flush();
+        }
+    }
+    co_await out.flush();
+    shutdown(out.fd(), SHUT_WR);
+}
+
+task<int> throw_error() {
+    throw std::runtime_error("task failed");
+    co_return 0;
+}
+
+task<> catch_error(std::string& message) {
+    try {
+        co_await throw_error();
+    } catch (const std::runtime_error& error) {
+        message = error.what();
+    }
+}
+
+TEST_CASE("Coroutines") {
+    SECTION("Tasks") {
+        std::string message;
+        spawn(catch_error(message));
+        REQUIRE(message == "task failed");
+
+        FILE* file = tmpfile();
+        ostream out(fileno(file));
+        bool flushed = false;
+        spawn([](ostream& out, bool& flushed) -> task<> {
+            out << 42;
+            flushed = !(co_await out.flush()).fail();
+        }(out, flushed));
+        REQUIRE(flushed);
+        char text[3] = {};
+        REQUIRE(pread(fileno(file), text, 2, 0) == 2);
+        REQUIRE(std::string_view(text) == "42");
+        fclose(file);
+    }
+
+    SECTION("Sockets") {
+        constexpr int kConnections = 8;
+        constexpr int kValues = 50'000;
+        reactor loop;
+        REQUIRE(loop.valid());
+        std::vector<std::array<int, 2>> sockets(kConnections);
+        std::vector<std::unique_ptr<awaitable_istream>> inputs;
+        std::vector<std::unique_ptr<awaitable_ostream>> outputs;
+        std::vector<int64_t> sums(kConnections);
+        int finished = 0;
+        for (int i = 0; i < kConnections; ++i) {
+            REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets[i].data()) == 0);
+            inputs.push_back(std::make_unique<awaitable_istream>(loop, sockets[i][0], 1000));
+            outputs.push_back(std::make_unique<awaitable_ostream>(loop, sockets[i][1], 1000));
+            spawn(receive_values(*inputs.back(), sums[i], finished));
+            spawn(send_values(*outputs.back(), kValues));
+        }
+        REQUIRE(loop.size() > 0);
+        loop.run();
+
+        REQUIRE(finished == kConnections);
+        REQUIRE(loop.size() == 0);
+        for (int i = 0; i < kConnections; ++i) {
+            REQUIRE(sums[i] == int64_t{kValues} * (kValues + 1) / 2);
+            REQUIRE(inputs[i]->eof());
+            REQUIRE(outputs[i]->pending() == 0);
+            close(sockets[i][0]);
+            close(sockets[i][1]);
+        }
+    }
+}
+
+// Run explicitly: test_iostream "[benchmark]"
+TEST_CASE("RangeIOBenchmark", "[.][benchmark]") {
+    FILE* file = tmpfile();
+    int fd = fileno(file);
+    RandomGenerator rnd(44);
+    auto ints = rnd.GenIntegralVector<int64_t>(5'000'000, -1'000'000'000, 1'000'000'000);
+    std::vector<int64_t> back(ints.size());
+    auto time = [](auto&& run) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto rewind = [fd](bool truncate) {
+        if (truncate) {
+            ftruncate(fd, 0);
+        }
+        lseek(fd, 0, SEEK_SET);
+    };
+    rewind(true);
+    double write_each = time([&] {
+        ostream out(fd);
+        for (int64_t value : ints) {
+            out << value << ' ';
+        }
+    });
+    rewind(true);
+    double write_range = time([&] { ostream(fd).write_range(ints); });
+    rewind(false);
+    double read_each = time([&] {
+        istream in(fd);
+        for (int64_t& value : back) {
+            in >> value;
+        }
+    });
+    REQUIRE(back == ints);
+    rewind(false);
+    double read_n = time([&] { istream(fd).read_n(std::span(back)); });
+    REQUIRE(back == ints);
+    rewind(false);
+    double parallel = time([&] { back = parallel_parser(fd).parse<int64_t>(); });
+    REQUIRE(back == ints);
+    WARN("write: <<  " << write_each << "s, write_range " << write_range << "s");
+    WARN("read:  >>  " << read_each << "s, read_n " << read_n << "s, parallel_parser "
+                       << parallel << "s");
+    fclose(file);
+}
 // NOLINTEND
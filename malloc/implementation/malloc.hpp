@@ -1,5 +1,14 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
 #include <sys/mman.h>
 #include <unistd.h>
 
@@ -15,74 +24,528 @@ constexpr size_t kBinsSize = 126;
 
 constexpr double kBigBinBase = 1.125;
 constexpr size_t kMaxSmallBinSize = 1024;
-}  // namespace constants
 
+constexpr size_t kAlignment = 16;
+constexpr size_t kFence = 1;
+}  // namespace constants
 
 namespace node_ptr {
 using BytePtr = std::byte*;
 
-void* Advance(void* ptr, int number);
-
-size_t Difference(void* first, void* second);
-
-size_t GetMeta(void* ptr);
-
-size_t GetSize(void* ptr);
-
-void SetMeta(void* ptr, size_t new_meta);
-
-void*& Next(void* ptr);
-
-void*& Prev(void* ptr);
-
-void* End(void* ptr);
-
-bool IsNumberValid(size_t number);
-
-bool IsValid(void* ptr);
-
-bool IsFree(void* ptr);
-
-bool IsMmaped(void* ptr);
-
-void SetOccupied(void* ptr, bool free);
+inline void* Advance(void* ptr, ptrdiff_t number) {
+    return static_cast<BytePtr>(ptr) + number;
+}
+
+inline size_t Difference(void* first, void* second) {
+    return static_cast<BytePtr>(first) - static_cast<BytePtr>(second);
+}
+
+inline size_t GetMeta(void* ptr) {
+    return *static_cast<size_t*>(Advance(ptr, -8));
+}
+
+inline size_t GetSize(void* ptr) {
+    return GetMeta(ptr) & (2 * constants::kMaxSize - 4);
+}
+
+inline void*& Next(void* ptr) {
+    return *static_cast<void**>(ptr);
+}
+
+inline void*& Prev(void* ptr) {
+    return *static_cast<void**>(Advance(ptr, 8));
+}
+
+inline void* End(void* ptr) {
+    return Advance(ptr, GetSize(ptr) - 8);
+}
+
+inline bool IsNumberValid(size_t number) {
+    return (number > 0) && (number <= constants::kMaxSize + 3);
+}
+
+inline bool IsValid(void* ptr) {
+    return IsNumberValid(GetMeta(ptr));
+}
+
+inline bool IsFree(void* ptr) {
+    return GetMeta(ptr) % 2 == 0;
+}
+
+inline bool IsMmaped(void* ptr) {
+    return (GetMeta(ptr) / 2) % 2 == 1;
+}
+
+inline void SetMeta(void* ptr, size_t new_meta) {
+    *static_cast<size_t*>(Advance(ptr, -8)) = new_meta;
+    *static_cast<size_t*>(Advance(ptr, (new_meta & (2 * constants::kMaxSize - 4)) - 16)) =
+        new_meta;
+}
+
+inline void SetOccupied(void* ptr, bool occupied) {
+    if (IsFree(ptr) == occupied) {
+        SetMeta(ptr, GetMeta(ptr) ^ 1);
+    }
+}
 }  // namespace node_ptr
 
-namespace utils {
-double Log(double number, double base);
-
-size_t GetIndex(size_t size);
-
-void* GetMmap(size_t size);
-
-size_t GetChunkSize(size_t size);
-
-void* GetMremap(void* ptr, size_t size);
-
-void* GetFrom(size_t size, void** container);
-
-void* GetFast(size_t size);
-
-void* GetBin(size_t size);
-
-void* GetFromHeap(size_t size);
-
-void AddTo(void* ptr, void** container);
-
-void AddToFast(void* ptr);
-
-void AddToBin(void* ptr);
-
-void FreeMmap(void* ptr);
-
-void* MergeNeighbours(void* ptr);
-
-void FreePtr(void* ptr);
-
-void ClearFast();
-}  // namespace utils
+namespace policy {
+// Size-class schemes: how a request is rounded to a chunk and which bin serves it.
+struct DefaultSizeClasses {
+    static constexpr size_t kMinSize = constants::kMinSize;
+    static constexpr size_t kFastMax = constants::kFastMax;
+    static constexpr size_t kFastConsolidate = constants::kFastConsolidate;
+    static constexpr size_t kMmapThreshold = constants::kMmapThreshold;
+
+    static size_t GetChunkSize(size_t size) {
+        if (size < kMinSize) {
+            return kMinSize;
+        }
+        return (size + constants::kAlignment - 1) / constants::kAlignment * constants::kAlignment;
+    }
+
+    static size_t GetIndex(size_t size) {
+        if (size <= constants::kMaxSmallBinSize) {
+            return size / constants::kAlignment - kMinSize / constants::kAlignment;
+        }
+        return 62 + static_cast<size_t>(std::log(static_cast<double>(size) /
+                                                 constants::kMaxSmallBinSize) /
+                                        std::log(constants::kBigBinBase));
+    }
+};
+
+struct PowerOfTwoSizeClasses {
+    static constexpr size_t kMinSize = constants::kMinSize;
+    static constexpr size_t kFastMax = 128;
+    static constexpr size_t kFastConsolidate = constants::kFastConsolidate;
+    static constexpr size_t kMmapThreshold = constants::kMmapThreshold;
+
+    static size_t GetChunkSize(size_t size) {
+        return std::max(kMinSize, std::bit_ceil(size));
+    }
+
+    static size_t GetIndex(size_t size) {
+        return std::bit_width(size) - std::bit_width(kMinSize);
+    }
+};
+
+// Bin structures: number of deferred-coalescing fast bins and of regular bins.
+template <size_t FastBinsSize, size_t BinsSize>
+struct SegregatedBins {
+    static constexpr size_t kFastBinsSize = FastBinsSize;
+    static constexpr size_t kBinsSize = BinsSize;
+};
+
+using DefaultBins = SegregatedBins<constants::kFastBinsSize, constants::kBinsSize>;
+using NoFastBins = SegregatedBins<0, constants::kBinsSize>;
+
+// Threading models: the mutex type guarding an allocator instance.
+struct SingleThreaded {
+    struct Mutex {
+        void lock() {
+        }
+        void unlock() {
+        }
+    };
+};
+
+struct MutexLocked {
+    using Mutex = std::mutex;
+};
+
+struct SpinLocked {
+    class Mutex {
+    public:
+        void lock() {
+            while (flag_.test_and_set(std::memory_order_acquire)) {
+                while (flag_.test(std::memory_order_relaxed)) {
+                }
+            }
+        }
+        void unlock() {
+            flag_.clear(std::memory_order_release);
+        }
+
+    private:
+        std::atomic_flag flag_;
+    };
+};
+
+// Backing sources: where heap segments and large chunks come from.
+struct SbrkSource {
+    static void* Grow(size_t size) {
+        void* ptr = sbrk(static_cast<intptr_t>(size));
+        return ptr == reinterpret_cast<void*>(-1) ? nullptr : ptr;
+    }
+};
+
+struct MmapSource {
+    static void* Grow(size_t size) {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+};
+
+// Hardening: whether pointers passed to free/realloc are validated.
+struct Hardened {
+    static constexpr bool kCheckPointers = true;
+
+    [[noreturn]] static void Fail(const char* message) {
+        [[maybe_unused]] auto written = write(STDERR_FILENO, message, strlen(message));
+        abort();
+    }
+};
+
+struct Unchecked {
+    static constexpr bool kCheckPointers = false;
+
+    [[noreturn]] static void Fail(const char*) {
+        abort();
+    }
+};
+}  // namespace policy
 
 namespace stdlike {
+template <class SizeClasses = policy::DefaultSizeClasses, class Bins = policy::DefaultBins,
+          class Threading = policy::MutexLocked, class Source = policy::SbrkSource,
+          class Hardening = policy::Hardened>
+class Allocator {
+public:
+    constexpr Allocator() = default;
+
+    Allocator(const Allocator&) = delete;
+    Allocator& operator=(const Allocator&) = delete;
+
+    void* Malloc(size_t size) {
+        std::lock_guard guard(mutex_);
+        return MallocUnlocked(size);
+    }
+
+    void* Calloc(size_t size, size_t amount) {
+        if (amount != 0 && size > SIZE_MAX / amount) {
+            return nullptr;
+        }
+        void* ptr = Malloc(size * amount);
+        if (ptr != nullptr) {
+            memset(ptr, 0, size * amount);
+        }
+        return ptr;
+    }
+
+    void* Realloc(void* ptr, size_t new_size) {
+        std::lock_guard guard(mutex_);
+        return ReallocUnlocked(ptr, new_size);
+    }
+
+    void Free(void* ptr) {
+        std::lock_guard guard(mutex_);
+        FreeUnlocked(ptr);
+    }
+
+private:
+    static constexpr size_t kFastBinsSize = Bins::kFastBinsSize;
+    static constexpr size_t kBinsSize = Bins::kBinsSize;
+    static constexpr bool kHasFastBins = kFastBinsSize > 0;
+
+    static size_t GetIndex(size_t size, size_t container_size) {
+        return std::min(SizeClasses::GetIndex(size), container_size - 1);
+    }
+
+    // 0 when the chunk would not fit the size field of the meta word.
+    static size_t GetChunkSize(size_t size) {
+        if (size > constants::kMaxSize - 16) {
+            return 0;
+        }
+        size_t chunk_size = SizeClasses::GetChunkSize(size + 16);
+        return chunk_size <= constants::kMaxSize ? chunk_size : 0;
+    }
+
+    void Check(void* ptr) {
+        if constexpr (Hardening::kCheckPointers) {
+            if (!node_ptr::IsValid(ptr)) {
+                Hardening::Fail("Is not valid pointer\n");
+            }
+        }
+    }
+
+    void* MallocUnlocked(size_t size) {
+        size_t real_size = GetChunkSize(size);
+        if (real_size == 0) {
+            return nullptr;
+        }
+        if (real_size > SizeClasses::kMmapThreshold) {
+            return GetMmap(real_size);
+        }
+        void* ptr = nullptr;
+        if constexpr (kHasFastBins) {
+            if (real_size <= SizeClasses::kFastMax) {
+                ptr = GetFrom(real_size, fast_bins_.data(), kFastBinsSize);
+            } else {
+                ClearFast();
+            }
+        }
+        if (ptr == nullptr) {
+            ptr = GetBin(real_size);
+        }
+        if (ptr == nullptr) {
+            ptr = GetFromHeap(real_size);
+            if (ptr == nullptr) {
+                return nullptr;
+            }
+        }
+        node_ptr::SetOccupied(ptr, true);
+        return ptr;
+    }
+
+    void* ReallocUnlocked(void* ptr, size_t new_size) {
+        if (ptr == nullptr) {
+            return MallocUnlocked(new_size);
+        }
+        Check(ptr);
+
+        size_t real_size = GetChunkSize(new_size);
+        if (real_size == 0) {
+            return nullptr;
+        }
+        if (node_ptr::IsMmaped(ptr)) {
+            return GetMremap(ptr, real_size);
+        }
+        if (real_size <= node_ptr::GetSize(ptr)) {
+            return ptr;
+        }
+        if (GrowInPlace(ptr, real_size)) {
+            return ptr;
+        }
+        void* new_ptr = MallocUnlocked(new_size);
+        if (new_ptr != nullptr) {
+            memcpy(new_ptr, ptr, node_ptr::GetSize(ptr) - 16);
+            FreeUnlocked(ptr);
+        }
+        return new_ptr;
+    }
+
+    void FreeUnlocked(void* ptr) {
+        if (ptr == nullptr) {
+            return;
+        }
+        Check(ptr);
+        if constexpr (Hardening::kCheckPointers) {
+            if (node_ptr::IsFree(ptr)) {
+                Hardening::Fail("Double free detected\n");
+            }
+        }
+
+        if (node_ptr::IsMmaped(ptr)) {
+            munmap(node_ptr::Advance(ptr, -16), node_ptr::GetSize(ptr) + 16);
+            return;
+        }
+
+        size_t size = node_ptr::GetSize(ptr);
+        if constexpr (kHasFastBins) {
+            if (size >= SizeClasses::kFastConsolidate) {
+                ClearFast();
+            } else if (size <= SizeClasses::kFastMax) {
+                AddTo(ptr, fast_bins_.data(), kFastBinsSize);
+                return;
+            }
+        }
+
+        FreePtr(ptr);
+    }
+
+    static void* GetMmap(size_t size) {
+        void* base =
+            mmap(nullptr, size + 16, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            return nullptr;
+        }
+        void* ptr = node_ptr::Advance(base, 16);
+        node_ptr::SetMeta(ptr, size + 3);
+        return ptr;
+    }
+
+    static void* GetMremap(void* ptr, size_t size) {
+        void* base = mremap(node_ptr::Advance(ptr, -16), node_ptr::GetSize(ptr) + 16, size + 16,
+                            MREMAP_MAYMOVE);
+        if (base == MAP_FAILED) {
+            return nullptr;
+        }
+        ptr = node_ptr::Advance(base, 16);
+        node_ptr::SetMeta(ptr, size + 3);
+        return ptr;
+    }
+
+    static void* GetFrom(size_t size, void** container, size_t container_size) {
+        size_t index = GetIndex(size, container_size);
+        void* ptr = container[index];
+        while (ptr != nullptr && node_ptr::GetSize(ptr) < size) {
+            ptr = node_ptr::Next(ptr);
+        }
+        while (ptr == nullptr && ++index < container_size) {
+            ptr = container[index];
+        }
+        if (ptr != nullptr) {
+            Unlink(ptr, container, container_size);
+        }
+        return ptr;
+    }
+
+    static void AddTo(void* ptr, void** container, size_t container_size) {
+        size_t index = GetIndex(node_ptr::GetSize(ptr), container_size);
+
+        void* last = container[index];
+        if (last != nullptr) {
+            node_ptr::Prev(last) = ptr;
+        }
+        container[index] = ptr;
+        node_ptr::Next(ptr) = last;
+        node_ptr::Prev(ptr) = nullptr;
+    }
+
+    static void Unlink(void* ptr, void** container, size_t container_size) {
+        if (node_ptr::Prev(ptr) != nullptr) {
+            node_ptr::Next(node_ptr::Prev(ptr)) = node_ptr::Next(ptr);
+        } else {
+            container[GetIndex(node_ptr::GetSize(ptr), container_size)] = node_ptr::Next(ptr);
+        }
+        if (node_ptr::Next(ptr) != nullptr) {
+            node_ptr::Prev(node_ptr::Next(ptr)) = node_ptr::Prev(ptr);
+        }
+    }
+
+    void AddToBin(void* ptr) {
+        node_ptr::SetOccupied(ptr, false);
+        AddTo(ptr, bins_.data(), kBinsSize);
+    }
+
+    void* GetBin(size_t size) {
+        void* ptr = GetFrom(size, bins_.data(), kBinsSize);
+        if (ptr != nullptr) {
+            Split(ptr, size);
+        }
+        return ptr;
+    }
+
+    void Split(void* ptr, size_t size) {
+        size_t last_size = node_ptr::GetSize(ptr);
+        if (last_size - size >= SizeClasses::kMinSize) {
+            node_ptr::SetMeta(ptr, size + node_ptr::GetMeta(ptr) % 2);
+            void* left = node_ptr::Advance(ptr, size);
+            node_ptr::SetMeta(left, last_size - size);
+            AddToBin(left);
+        }
+    }
+
+    void* NewSegment(size_t size) {
+        size_t segment_size =
+            std::max(SizeClasses::kMmapThreshold, size + 4 * constants::kAlignment);
+        segment_size = (segment_size + SizeClasses::kMmapThreshold - 1) /
+                       SizeClasses::kMmapThreshold * SizeClasses::kMmapThreshold;
+        void* segment = Source::Grow(segment_size);
+        if (segment == nullptr) {
+            return nullptr;
+        }
+        if (segment == heap_end_) {
+            heap_end_ = node_ptr::Advance(heap_end_, segment_size);
+            return heap_top_;
+        }
+        if (heap_top_ != nullptr) {
+            *static_cast<size_t*>(heap_top_) = constants::kFence;
+        }
+        auto user = reinterpret_cast<uintptr_t>(node_ptr::Advance(segment, 2 * sizeof(size_t)));
+        user = (user + constants::kAlignment - 1) / constants::kAlignment * constants::kAlignment;
+        heap_top_ = reinterpret_cast<void*>(user - sizeof(size_t));
+        *static_cast<size_t*>(node_ptr::Advance(heap_top_, -8)) = constants::kFence;
+        heap_end_ = node_ptr::Advance(segment, segment_size);
+        return heap_top_;
+    }
+
+    void* GetFromHeap(size_t size) {
+        if (heap_top_ == nullptr ||
+            node_ptr::Difference(heap_end_, heap_top_) < size + sizeof(size_t)) {
+            if (NewSegment(size) == nullptr) {
+                return nullptr;
+            }
+        }
+        void* ptr = node_ptr::Advance(heap_top_, 8);
+        node_ptr::SetMeta(ptr, size + 1);
+        heap_top_ = node_ptr::Advance(heap_top_, size);
+        return ptr;
+    }
+
+    void* MergeNeighbours(void* ptr) {
+        size_t prev_meta = *static_cast<size_t*>(node_ptr::Advance(ptr, -16));
+        if (node_ptr::IsNumberValid(prev_meta) && prev_meta % 2 == 0) {
+            void* prev = node_ptr::Advance(ptr, -static_cast<ptrdiff_t>(prev_meta));
+            Unlink(prev, bins_.data(), kBinsSize);
+            node_ptr::SetMeta(prev, node_ptr::GetSize(prev) + node_ptr::GetSize(ptr));
+            ptr = prev;
+        }
+        if (node_ptr::End(ptr) != heap_top_) {
+            void* next = node_ptr::Advance(node_ptr::End(ptr), 8);
+            if (node_ptr::IsFree(next)) {
+                Unlink(next, bins_.data(), kBinsSize);
+                node_ptr::SetMeta(ptr, node_ptr::GetSize(next) + node_ptr::GetSize(ptr));
+            }
+        }
+        return ptr;
+    }
+
+    bool GrowInPlace(void* ptr, size_t size) {
+        if (node_ptr::End(ptr) == heap_top_) {
+            size_t extra = size - node_ptr::GetSize(ptr);
+            if (node_ptr::Difference(heap_end_, heap_top_) < extra + sizeof(size_t)) {
+                return false;
+            }
+            heap_top_ = node_ptr::Advance(heap_top_, extra);
+            node_ptr::SetMeta(ptr, size + 1);
+            return true;
+        }
+        void* next = node_ptr::Advance(node_ptr::End(ptr), 8);
+        if (!node_ptr::IsFree(next) || node_ptr::GetSize(ptr) + node_ptr::GetSize(next) < size) {
+            return false;
+        }
+        Unlink(next, bins_.data(), kBinsSize);
+        node_ptr::SetMeta(ptr, node_ptr::GetSize(ptr) + node_ptr::GetSize(next) + 1);
+        Split(ptr, size);
+        return true;
+    }
+
+    void FreePtr(void* ptr) {
+        node_ptr::SetOccupied(ptr, false);
+        ptr = MergeNeighbours(ptr);
+        if (node_ptr::End(ptr) == heap_top_) {
+            heap_top_ = node_ptr::Advance(ptr, -8);
+        } else {
+            AddToBin(ptr);
+        }
+    }
+
+    void ClearFast() {
+        for (auto*& ptr : fast_bins_) {
+            void* now = ptr;
+            ptr = nullptr;
+            while (now != nullptr) {
+                void* next = node_ptr::Next(now);
+                FreePtr(now);
+                now = next;
+            }
+        }
+    }
+
+    std::array<void*, kFastBinsSize> fast_bins_{};
+    std::array<void*, kBinsSize> bins_{};
+
+    void* heap_top_ = nullptr;
+    void* heap_end_ = nullptr;
+
+    [[no_unique_address]] typename Threading::Mutex mutex_;
+};
+
+using DefaultAllocator = Allocator<>;
+using SingleThreadedAllocator =
+    Allocator<policy::DefaultSizeClasses, policy::DefaultBins, policy::SingleThreaded>;
+
 void* malloc(size_t size);
 
 void* calloc(size_t size, size_t amount);
@@ -90,4 +553,4 @@ void* calloc(size_t size, size_t amount);
 void* realloc(void* ptr, size_t new_size);
 
 void free(void* ptr);
-}  // namespace stdlike
\ No newline at end of file
+}  // namespace stdlike
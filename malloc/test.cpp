@@ -1,7 +1,139 @@
 #include "implementation/malloc.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
+#include "util.h"
+
+namespace {
+template <class Alloc>
+void StressAllocator(Alloc& allocator, size_t iterations, size_t max_size) {
+    RandomGenerator rnd;
+    std::vector<std::pair<uint8_t*, size_t>> blocks;
+    for (size_t i = 0; i < iterations; ++i) {
+        if (blocks.empty() || rnd.GenInt<int>(0, 2) != 0) {
+            size_t size = rnd.GenInt<size_t>(1, max_size);
+            auto* ptr = static_cast<uint8_t*>(allocator.Malloc(size));
+            REQUIRE(ptr != nullptr);
+            REQUIRE(reinterpret_cast<uintptr_t>(ptr) % 16 == 0);
+            memset(ptr, static_cast<int>(size % 251), size);
+            blocks.emplace_back(ptr, size);
+        } else {
+            size_t index = rnd.GenInt<size_t>(0, blocks.size() - 1);
+            auto [ptr, size] = blocks[index];
+            REQUIRE(std::all_of(ptr, ptr + size, [size](uint8_t byte) {
+                return byte == size % 251;
+            }));
+            allocator.Free(ptr);
+            blocks[index] = blocks.back();
+            blocks.pop_back();
+        }
+    }
+    for (auto [ptr, size] : blocks) {
+        allocator.Free(ptr);
+    }
+}
+}  // namespace
+
 TEST_CASE("Empty") {
     REQUIRE(true);
 }
+
+TEST_CASE("Basic") {
+    void* ptr = stdlike::malloc(100);
+    REQUIRE(ptr != nullptr);
+    memset(ptr, 1, 100);
+    stdlike::free(ptr);
+    stdlike::free(nullptr);
+
+    auto* zeroes = static_cast<char*>(stdlike::calloc(10, 100));
+    REQUIRE(zeroes != nullptr);
+    for (size_t i = 0; i < 1000; ++i) {
+        REQUIRE(zeroes[i] == 0);
+    }
+    stdlike::free(zeroes);
+}
+
+TEST_CASE("Realloc") {
+    auto* ptr = static_cast<char*>(stdlike::malloc(16));
+    for (int i = 0; i < 16; ++i) {
+        ptr[i] = static_cast<char>(i);
+    }
+    for (size_t size : {100, 1000, 100'000, 1'000'000, 50, 4'000'000}) {
+        ptr = static_cast<char*>(stdlike::realloc(ptr, size));
+        REQUIRE(ptr != nullptr);
+        for (int i = 0; i < 16; ++i) {
+            REQUIRE(ptr[i] == i);
+        }
+    }
+    stdlike::free(ptr);
+}
+
+TEST_CASE("LargeBlocks") {
+    constexpr size_t kSize = 20 << 20;
+    auto* ptr = static_cast<char*>(stdlike::malloc(kSize));
+    REQUIRE(ptr != nullptr);
+    ptr[0] = 1;
+    ptr[kSize - 1] = 2;
+    ptr = static_cast<char*>(stdlike::realloc(ptr, constants::kMaxSize - 16));
+    REQUIRE(ptr != nullptr);
+    REQUIRE((ptr[0] == 1 && ptr[kSize - 1] == 2));
+    stdlike::free(ptr);
+    REQUIRE(stdlike::malloc(constants::kMaxSize) == nullptr);
+
+    stdlike::Allocator<policy::PowerOfTwoSizeClasses> allocator;
+    void* power_of_two = allocator.Malloc(kSize);
+    REQUIRE(power_of_two != nullptr);
+    allocator.Free(power_of_two);
+}
+
+TEST_CASE("Stress") {
+    stdlike::DefaultAllocator allocator;
+    StressAllocator(allocator, 20'000, 2'000);
+    StressAllocator(allocator, 2'000, 300'000);
+}
+
+TEST_CASE("Policies") {
+    SECTION("SingleThreaded") {
+        stdlike::SingleThreadedAllocator allocator;
+        StressAllocator(allocator, 20'000, 2'000);
+    }
+    SECTION("NoFastBinsMmapUnchecked") {
+        stdlike::Allocator<policy::DefaultSizeClasses, policy::NoFastBins, policy::SingleThreaded,
+                           policy::MmapSource, policy::Unchecked>
+            allocator;
+        StressAllocator(allocator, 20'000, 5'000);
+    }
+    SECTION("PowerOfTwoSpinLocked") {
+        stdlike::Allocator<policy::PowerOfTwoSizeClasses, policy::DefaultBins, policy::SpinLocked>
+            allocator;
+        StressAllocator(allocator, 20'000, 5'000);
+    }
+}
+
+TEST_CASE("Threads") {
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([] {
+            std::vector<void*> ptrs;
+            for (int j = 0; j < 10'000; ++j) {
+                ptrs.push_back(stdlike::malloc(j % 500 + 1));
+                if (j % 3 == 0) {
+                    stdlike::free(ptrs.back());
+                    ptrs.pop_back();
+                }
+            }
+            for (void* ptr : ptrs) {
+                stdlike::free(ptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(true);
+}